@@ -1,13 +1,109 @@
 #ifndef TWOBODY_ANOMALY_H
 #define TWOBODY_ANOMALY_H
 
+#include <stddef.h>
+
+enum anomaly_solver {
+    ANOMALY_SOLVER_LAGUERRE_CONWAY, // iterative, 1..10 steps
+    ANOMALY_SOLVER_MARKLEY,         // non-iterative, fixed cost (elliptic)
+    ANOMALY_SOLVER_FIXED,           // constant step count, no early exit
+};
+
+#ifndef TWOBODY_ANOMALY_SOLVER
+#define TWOBODY_ANOMALY_SOLVER ANOMALY_SOLVER_LAGUERRE_CONWAY
+#endif
+
+// |e - 1| below this uses the near-parabolic solver
+#define ANOMALY_NEAR_PARABOLIC 0.01
+
+// e below this uses a series instead of iteration (near-circular)
+#define ANOMALY_SERIES 0.01
+
+void anomaly_set_solver(enum anomaly_solver solver);
+enum anomaly_solver anomaly_get_solver();
+
+// largest default step count of the iterative solvers
+#define ANOMALY_MAX_STEPS 20
+
+// opt-in step count histogram of the iterative solvers (not _fixed),
+// histogram[k] counts the solves that took k steps, the last of the
+// ANOMALY_MAX_STEPS + 1 entries counts longer ones, 0 turns it off,
+// the pointer and counts are shared by all threads, not synchronised: set it
+// only around single-threaded tests and benchmarks
+void anomaly_set_histogram(unsigned long *histogram);
+
+// _tol: stop when the squared step is below tol (relative for near-parabolic),
+// the error is then about tol or less, DBL_EPSILON is full precision
 double anomaly_eccentric_iterate(double e, double M, double E0, int max_steps);
+double anomaly_eccentric_iterate_tol(
+    double e, double M, double E0,
+    int max_steps, double tol);
+double anomaly_eccentric_iterate_fixed(double e, double M, double E0, int steps);
+double anomaly_eccentric_markley(double e, double M);
+double anomaly_hyperbolic_guess(double e, double M);
+double anomaly_hyperbolic_iterate(double e, double M, double H0, int max_steps);
+double anomaly_hyperbolic_iterate_tol(
+    double e, double M, double H0,
+    int max_steps, double tol);
+double anomaly_hyperbolic_iterate_fixed(double e, double M, double H0, int steps);
+double anomaly_eccentric_series(double e, double M);
+double anomaly_true_series(double e, double M);
+double anomaly_near_parabolic(double e, double M, int max_steps);
+double anomaly_near_parabolic_tol(double e, double M, int max_steps, double tol);
+double anomaly_near_parabolic_fixed(double e, double M, int steps);
+// warm start from E0 (eccentric or hyperbolic anomaly), e.g. a previous solution
+double anomaly_near_parabolic_iterate(double e, double M, double E0, int max_steps);
+int anomaly_is_near_parabolic(double e, double M);
+int anomaly_fixed_steps(double e, double M);
+double anomaly_mean_to_eccentric_fixed(double e, double M);
 double anomaly_mean_to_eccentric(double e, double M);
+double anomaly_mean_to_eccentric_tol(double e, double M, double tol);
+void anomaly_mean_to_eccentric_n(
+    const double *e, const double *M,
+    double *E,
+    size_t n);
+void anomaly_mean_to_eccentric_n_tol(
+    const double *e, const double *M,
+    double *E,
+    size_t n,
+    double tol);
+
+// single precision (about 1e-6 rad), reduce large M in double first
+float anomaly_mean_to_eccentric_f(float e, float M);
+void anomaly_mean_to_eccentric_nf(
+    const float *e, const float *M,
+    float *E,
+    size_t n);
+
+// single precision guess refined by one double precision step
+double anomaly_mean_to_eccentric_mixed(double e, double M);
+void anomaly_mean_to_eccentric_mixed_n(
+    const double *e, const double *M,
+    double *E,
+    size_t n);
 double anomaly_eccentric_to_mean(double e, double E);
 double anomaly_eccentric_to_true(double e, double E);
 double anomaly_true_to_eccentric(double e, double f);
 double anomaly_true_to_mean(double e, double f);
 double anomaly_mean_to_true(double e, double M);
+
+// batch conversions, 4 at a time with any mix of conic types
+void anomaly_eccentric_to_true_n(
+    const double *e, const double *E,
+    double *f,
+    size_t n);
+void anomaly_true_to_eccentric_n(
+    const double *e, const double *f,
+    double *E,
+    size_t n);
+void anomaly_true_to_mean_n(
+    const double *e, const double *f,
+    double *M,
+    size_t n);
+void anomaly_mean_to_true_n(
+    const double *e, const double *M,
+    double *f,
+    size_t n);
 double anomaly_dEdM(double e, double E);
 double anomaly_dfdE(double e, double E);
 
@@ -1,6 +1,14 @@
 #ifndef TWOBODY_CONIC_H
 #define TWOBODY_CONIC_H
 
+enum conic_type {
+    CONIC_CIRCULAR,
+    CONIC_ELLIPTIC,
+    CONIC_PARABOLIC,
+    CONIC_HYPERBOLIC,
+};
+
+enum conic_type conic_type(double e);
 int conic_circular(double e);
 int conic_elliptic(double e);
 int conic_parabolic(double e);
@@ -21,6 +21,68 @@ double eccentric_y(double p, double e, double E);
 double eccentric_xdot(double mu, double p, double e, double E);
 double eccentric_ydot(double mu, double p, double e, double E);
 
+// eccentric_x, eccentric_y, eccentric_xdot and eccentric_ydot from one
+// classification and one sin/cos (sinh/cosh)
+void eccentric_state_2d(
+    double mu, double p, double e,
+    double E,
+    double *x, double *y,
+    double *xdot, double *ydot);
+
+// per conic type kernels of eccentric_state_2d and the orbit state functions,
+// a and b are the semi-axes, n the mean motion, q the periapsis distance and
+// w = sqrt(mu / p) (see orbit_prepare)
+static inline void eccentric_xy_elliptic(
+    double e, double a, double b, double n,
+    double cosE, double sinE,
+    double *x, double *y, double *xdot, double *ydot)
+    __attribute__((always_inline));
+static inline void eccentric_xy_elliptic(
+    double e, double a, double b, double n,
+    double cosE, double sinE,
+    double *x, double *y, double *xdot, double *ydot) {
+    double k = n / (1.0 - e*cosE);
+
+    *x = a * (cosE - e);
+    *y = b * sinE;
+    *xdot = -a*sinE * k;
+    *ydot = b*cosE * k;
+}
+
+static inline void eccentric_xy_hyperbolic(
+    double e, double a, double b, double n,
+    double coshE, double sinhE,
+    double *x, double *y, double *xdot, double *ydot)
+    __attribute__((always_inline));
+static inline void eccentric_xy_hyperbolic(
+    double e, double a, double b, double n,
+    double coshE, double sinhE,
+    double *x, double *y, double *xdot, double *ydot) {
+    double k = n / (e*coshE - 1.0);
+
+    *x = a * (coshE - e);
+    *y = b * sinhE;
+    *xdot = a*sinhE * k;
+    *ydot = b*coshE * k;
+}
+
+static inline void eccentric_xy_parabolic(
+    double q, double p, double w,
+    double E,
+    double *x, double *y, double *xdot, double *ydot)
+    __attribute__((always_inline));
+static inline void eccentric_xy_parabolic(
+    double q, double p, double w,
+    double E,
+    double *x, double *y, double *xdot, double *ydot) {
+    double k = w / (E*E + 1.0);
+
+    *x = q * (1.0 - E*E);
+    *y = p * E;
+    *xdot = -2.0*E * k;
+    *ydot = 2.0 * k;
+}
+
 double eccentric_f(
     double mu, double p, double e,
     double r0,
@@ -0,0 +1,26 @@
+#ifndef TWOBODY_KEPLER_H
+#define TWOBODY_KEPLER_H
+
+#define KEPLER_CTX_SEGMENTS 128
+
+// Laguerre-Conway (near-parabolic) steps after the table lookup
+#define KEPLER_CTX_STEPS 1
+
+// Precomputed Kepler equation solver for a fixed elliptic eccentricity.
+// E(M) on 0..pi is approximated with piecewise cubic Hermite polynomials,
+// nodes at E = pi * (k/N)^(1 + 3e), denser near periapsis as E(M) turns
+// into a cube root for e -> 1. The guess is within about 1e-6 for any
+// elliptic e, so a single refinement step reaches full precision.
+struct kepler_ctx {
+    double eccentricity;
+    double mean_anomaly[KEPLER_CTX_SEGMENTS+1]; // segment start points
+    double coeffs[KEPLER_CTX_SEGMENTS][4];
+};
+
+void kepler_ctx_init(struct kepler_ctx *ctx, double e);
+
+double kepler_ctx_eccentricity(const struct kepler_ctx *ctx);
+double kepler_ctx_guess(const struct kepler_ctx *ctx, double M);
+double kepler_ctx_mean_to_eccentric(const struct kepler_ctx *ctx, double M);
+
+#endif
@@ -1,16 +1,33 @@
 #ifndef TWOBODY_ORBIT_H
 #define TWOBODY_ORBIT_H
 
+#include <twobody/conic.h>
+
+#include <stddef.h>
+
 #ifndef TWOBODY_NO_SIMD
 #include <twobody/simd4d.h>
 #endif
 
+struct kepler_ctx;
+
 struct orbit {
     double gravity_parameter;
     double orbital_energy;
     double angular_momentum;
     double periapsis_time;
 
+    // derived from the above by orbit_prepare, no divisions or square
+    // roots left for each state
+    double semi_latus_rectum;
+    double eccentricity;
+    double semi_major_axis;
+    double semi_minor_axis;
+    double periapsis;
+    double mean_motion;
+    double velocity_scale; // sqrt(mu / p)
+    enum conic_type type;
+
 #ifndef TWOBODY_NO_SIMD
     vec4d major_axis;
     vec4d minor_axis;
@@ -20,14 +37,28 @@ struct orbit {
     double minor_axis[4];
     double normal_axis[4];
 #endif
+
+    // optional initial guess for orbit_state_time, not owned
+    const struct kepler_ctx *kepler_ctx;
 };
 
+// orbit_from_state with pos and vel as (x, y, z)
 void orbit_from_state_ptr(
     struct orbit *orbit,
     double mu,
     const double *pos, const double *vel,
     double epoch);
 
+// orbit_from_state over arrays of n states (x, y, z) and epochs, the same
+// kernel for both, the orbits are bit for bit the same
+void orbit_from_state_n(
+    struct orbit *orbits,
+    double mu,
+    const double *x, const double *y, const double *z,
+    const double *vx, const double *vy, const double *vz,
+    const double *epoch,
+    size_t n);
+
 void orbit_from_elements(
     struct orbit *orbit,
     double mu,
@@ -35,11 +66,19 @@ void orbit_from_elements(
     double i, double an, double arg,
     double periapsis_time);
 
+// recompute the derived quantities after changing the fields above,
+// orbit_from_state, orbit_from_state_n and orbit_from_elements call this,
+// code that writes the fields directly must call it before any state
+void orbit_prepare(struct orbit *orbit);
+
 double orbit_gravity_parameter(const struct orbit *orbit);
 double orbit_orbital_energy(const struct orbit *orbit);
 double orbit_angular_momentum(const struct orbit *orbit);
 double orbit_periapsis_time(const struct orbit *orbit);
 
+void orbit_set_kepler_ctx(struct orbit *orbit, const struct kepler_ctx *ctx);
+const struct kepler_ctx *orbit_kepler_ctx(const struct orbit *orbit);
+
 int orbit_zero(const struct orbit *orbit);
 int orbit_radial(const struct orbit *orbit);
 int orbit_parabolic(const struct orbit *orbit);
@@ -57,15 +96,46 @@ void orbit_state_eccentric(
     const struct orbit *orbit,
     double *pos, double *vel,
     double E);
+
+// n states at true anomalies f, pos and vel hold 4 doubles per state
+void orbit_state_true_n(
+    const struct orbit *orbit,
+    double *pos, double *vel,
+    const double *f,
+    size_t n);
 void orbit_state_time(
     const struct orbit *orbit,
     double *pos, double *vel,
     double t);
 
+// single precision state (x, y, z, 0), relative error about 1e-6
+void orbit_state_time_f(
+    const struct orbit *orbit,
+    float *pos, float *vel,
+    double t);
+
+// Sequential propagation, previous eccentric anomaly is extrapolated
+// as the initial guess for the next time (dense ephemerides)
+struct orbit_cursor {
+    const struct orbit *orbit;
+
+    double time;
+    double mean_anomaly;
+    double eccentric_anomaly;
+};
+
+void orbit_cursor_init(
+    struct orbit_cursor *cursor,
+    const struct orbit *orbit,
+    double t);
+void orbit_cursor_advance(
+    struct orbit_cursor *cursor,
+    double *pos, double *vel,
+    double t);
+
 #ifndef TWOBODY_NO_SIMD
 #include <twobody/math_utils.h>
 
-#include <twobody/conic.h>
 #include <twobody/anomaly.h>
 #include <twobody/true_anomaly.h>
 #include <twobody/eccentric_anomaly.h>
@@ -81,117 +151,186 @@ static inline void orbit_from_state(
     double mu,
     vec4d pos, vec4d vel,
     double epoch) {
-    double r2 = dot(pos, pos);
-    double r = sqrt(r2);
-    double v2 = dot(vel, vel);
-
-    // specific orbital energy
-    double visviva = v2/2.0 - mu/r;
-
-    // specific relative angular momentum
-    vec4d h = cross(pos, vel);
-
-    if(dot(h, h) < DBL_EPSILON) {       // radial trajectory
-        vec4d major = r2 < DBL_EPSILON ?
-            (vec4d){ 1.0, 0.0, 0.0, 0.0 } : unit4d(pos);
-        vec4d up = (major[0]*major[0] + major[1]*major[1] < DBL_EPSILON) ?
-            (vec4d){ 0.0, 1.0, 0.0, 0.0 } :
-            (vec4d){ 0.0, 0.0, 1.0, 0.0 };
-        vec4d minor = cross(up, major);
-        vec4d normal = cross(major, minor);
-
-        orbit->gravity_parameter = mu;
-        orbit->orbital_energy = visviva;
-        orbit->angular_momentum = 0.0;
-        orbit->periapsis_time = NAN; // TODO: radial trajectory equation
-        orbit->major_axis = major;
-        orbit->minor_axis = minor;
-        orbit->normal_axis = normal;
-    } else {                            // conic trajectory
-        // semi-latus rectum
-        double p = dot(h, h) / mu;
-
-        // eccentricity vector
-        vec4d ecc = splat4d(1.0/mu) *
-            (splat4d(v2 - mu/r)*pos - dot4d(pos, vel) * vel);
-        double e2 = dot(ecc, ecc);
-        double e = sqrt(e2);
-        int circular = e2 < DBL_EPSILON;
-
-        // orbit normal vector
-        vec4d normal = unit4d(h);
-
-        // ascending node
-        vec4d nodes = (vec4d){ -normal[1], normal[0], 0.0, 0.0 };
-        int equatorial = dot(nodes, nodes) < DBL_EPSILON;
-
-        vec4d major = circular && equatorial ?
-            (vec4d){ 1.0, 0.0, 0.0, 0.0 } : // circular & equatorial -> x-axis
-            (circular ?  unit4d(nodes) :    // circular -> line of nodes
-                unit4d(ecc));               // eccentricity vector
-        vec4d minor = cross(normal, major);
-
-        // true anomaly
-        double f0 = -sign(dot(vel, major)) *
-            acos(clamp(-1.0, 1.0, dot(major, pos) / r));
-
-        // mean anomaly and mean motion
-        double M0 = anomaly_true_to_mean(e, f0);
-        double n = conic_mean_motion(mu, p, e);
-
-        // periapsis time
-        double t0 = epoch - M0 / n;
-
-        orbit->gravity_parameter = mu;
-        orbit->orbital_energy = visviva;
-        orbit->angular_momentum = mag(h);
-        orbit->periapsis_time = t0;
-        orbit->major_axis = major;
-        orbit->minor_axis = minor;
-        orbit->normal_axis = normal;
-    }
+    orbit_from_state_ptr(orbit, mu, (const double*)&pos, (const double*)&vel, epoch);
+}
+
+// true_state_xy and the eccentric_xy_* kernels for 4 anomalies
+static inline void true_state_xy4d(
+    vec4d p, vec4d e, vec4d k,
+    vec4d cos_f, vec4d sin_f,
+    vec4d *x, vec4d *y, vec4d *xdot, vec4d *ydot)
+    __attribute__((always_inline));
+static inline void true_state_xy4d(
+    vec4d p, vec4d e, vec4d k,
+    vec4d cos_f, vec4d sin_f,
+    vec4d *x, vec4d *y, vec4d *xdot, vec4d *ydot) {
+    vec4d r = p / (splat4d(1.0) + e * cos_f);
+
+    *x = r * cos_f;
+    *y = r * sin_f;
+    *xdot = -k * sin_f;
+    *ydot = k * (e + cos_f);
+}
+
+static inline void eccentric_xy_elliptic4d(
+    vec4d e, vec4d a, vec4d b, vec4d n,
+    vec4d cosE, vec4d sinE,
+    vec4d *x, vec4d *y, vec4d *xdot, vec4d *ydot)
+    __attribute__((always_inline));
+static inline void eccentric_xy_elliptic4d(
+    vec4d e, vec4d a, vec4d b, vec4d n,
+    vec4d cosE, vec4d sinE,
+    vec4d *x, vec4d *y, vec4d *xdot, vec4d *ydot) {
+    vec4d k = n / (splat4d(1.0) - e*cosE);
+
+    *x = a * (cosE - e);
+    *y = b * sinE;
+    *xdot = -a*sinE * k;
+    *ydot = b*cosE * k;
+}
+
+static inline void eccentric_xy_hyperbolic4d(
+    vec4d e, vec4d a, vec4d b, vec4d n,
+    vec4d coshE, vec4d sinhE,
+    vec4d *x, vec4d *y, vec4d *xdot, vec4d *ydot)
+    __attribute__((always_inline));
+static inline void eccentric_xy_hyperbolic4d(
+    vec4d e, vec4d a, vec4d b, vec4d n,
+    vec4d coshE, vec4d sinhE,
+    vec4d *x, vec4d *y, vec4d *xdot, vec4d *ydot) {
+    vec4d k = n / (e*coshE - splat4d(1.0));
+
+    *x = a * (coshE - e);
+    *y = b * sinhE;
+    *xdot = a*sinhE * k;
+    *ydot = b*coshE * k;
+}
+
+static inline void eccentric_xy_parabolic4d(
+    vec4d q, vec4d p, vec4d w,
+    vec4d E,
+    vec4d *x, vec4d *y, vec4d *xdot, vec4d *ydot)
+    __attribute__((always_inline));
+static inline void eccentric_xy_parabolic4d(
+    vec4d q, vec4d p, vec4d w,
+    vec4d E,
+    vec4d *x, vec4d *y, vec4d *xdot, vec4d *ydot) {
+    vec4d k = w / (E*E + splat4d(1.0));
+
+    *x = q * (splat4d(1.0) - E*E);
+    *y = p * E;
+    *xdot = splat4d(-2.0)*E * k;
+    *ydot = splat4d(2.0) * k;
+}
+
+static inline void orbit_xy_true(
+    const struct orbit *orbit,
+    double cos_f, double sin_f,
+    double *x, double *y, double *xdot, double *ydot)
+    __attribute__((always_inline));
+static inline void orbit_xy_true(
+    const struct orbit *orbit,
+    double cos_f, double sin_f,
+    double *x, double *y, double *xdot, double *ydot) {
+    true_state_xy(orbit->semi_latus_rectum, orbit->eccentricity,
+        orbit->velocity_scale, cos_f, sin_f, x, y, xdot, ydot);
 }
 
 static inline vec4d orbit_position_true(const struct orbit *orbit, double f)
     __attribute__((always_inline));
 static inline vec4d orbit_position_true(const struct orbit *orbit, double f) {
-    double p = orbit_semi_latus_rectum(orbit);
-    double e = orbit_eccentricity(orbit);
+    double x, y, xdot, ydot;
+    orbit_xy_true(orbit, cos(f), sin(f), &x, &y, &xdot, &ydot);
 
-    return splat4d(true_x(p, e, f)) * orbit->major_axis +
-        splat4d(true_y(p, e, f)) * orbit->minor_axis;
+    return splat4d(x) * orbit->major_axis + splat4d(y) * orbit->minor_axis;
 }
 
 static inline vec4d orbit_velocity_true(const struct orbit *orbit, double f)
     __attribute__((always_inline));
 static inline vec4d orbit_velocity_true(const struct orbit *orbit, double f) {
-    double mu = orbit_gravity_parameter(orbit);
-    double p = orbit_semi_latus_rectum(orbit);
-    double e = orbit_eccentricity(orbit);
+    double x, y, xdot, ydot;
+    orbit_xy_true(orbit, cos(f), sin(f), &x, &y, &xdot, &ydot);
+
+    return splat4d(xdot) * orbit->major_axis + splat4d(ydot) * orbit->minor_axis;
+}
 
-    return splat4d(true_xdot(mu, p, e, f)) * orbit->major_axis +
-        splat4d(true_ydot(mu, p, e, f)) * orbit->minor_axis;
+// the eccentric_xy_* kernels with the constants of orbit_prepare,
+// orbit->type selects one
+static inline void orbit_xy_elliptic(
+    const struct orbit *orbit,
+    double cosE, double sinE,
+    double *x, double *y, double *xdot, double *ydot)
+    __attribute__((always_inline));
+static inline void orbit_xy_elliptic(
+    const struct orbit *orbit,
+    double cosE, double sinE,
+    double *x, double *y, double *xdot, double *ydot) {
+    eccentric_xy_elliptic(orbit->eccentricity,
+        orbit->semi_major_axis, orbit->semi_minor_axis, orbit->mean_motion,
+        cosE, sinE, x, y, xdot, ydot);
+}
+
+static inline void orbit_xy_parabolic(
+    const struct orbit *orbit,
+    double E,
+    double *x, double *y, double *xdot, double *ydot)
+    __attribute__((always_inline));
+static inline void orbit_xy_parabolic(
+    const struct orbit *orbit,
+    double E,
+    double *x, double *y, double *xdot, double *ydot) {
+    eccentric_xy_parabolic(orbit->periapsis,
+        orbit->semi_latus_rectum, orbit->velocity_scale,
+        E, x, y, xdot, ydot);
+}
+
+static inline void orbit_xy_hyperbolic(
+    const struct orbit *orbit,
+    double E,
+    double *x, double *y, double *xdot, double *ydot)
+    __attribute__((always_inline));
+static inline void orbit_xy_hyperbolic(
+    const struct orbit *orbit,
+    double E,
+    double *x, double *y, double *xdot, double *ydot) {
+    eccentric_xy_hyperbolic(orbit->eccentricity,
+        orbit->semi_major_axis, orbit->semi_minor_axis, orbit->mean_motion,
+        cosh(E), sinh(E), x, y, xdot, ydot);
+}
+
+static inline void orbit_xy_eccentric(
+    const struct orbit *orbit,
+    double E,
+    double *x, double *y, double *xdot, double *ydot)
+    __attribute__((always_inline));
+static inline void orbit_xy_eccentric(
+    const struct orbit *orbit,
+    double E,
+    double *x, double *y, double *xdot, double *ydot) {
+    if(orbit->type == CONIC_HYPERBOLIC)
+        orbit_xy_hyperbolic(orbit, E, x, y, xdot, ydot);
+    else if(orbit->type == CONIC_PARABOLIC)
+        orbit_xy_parabolic(orbit, E, x, y, xdot, ydot);
+    else // circular or elliptic
+        orbit_xy_elliptic(orbit, cos(E), sin(E), x, y, xdot, ydot);
 }
 
 static inline vec4d orbit_position_eccentric(const struct orbit *orbit, double E)
     __attribute__((always_inline));
 static inline vec4d orbit_position_eccentric(const struct orbit *orbit, double E) {
-    double p = orbit_semi_latus_rectum(orbit);
-    double e = orbit_eccentricity(orbit);
+    double x, y, xdot, ydot;
+    orbit_xy_eccentric(orbit, E, &x, &y, &xdot, &ydot);
 
-    return splat4d(eccentric_x(p, e, E)) * orbit->major_axis +
-        splat4d(eccentric_y(p, e, E)) * orbit->minor_axis;
+    return splat4d(x) * orbit->major_axis + splat4d(y) * orbit->minor_axis;
 }
 
 static inline vec4d orbit_velocity_eccentric(const struct orbit *orbit, double E)
     __attribute__((always_inline));
 static inline vec4d orbit_velocity_eccentric(const struct orbit *orbit, double E) {
-    double mu = orbit_gravity_parameter(orbit);
-    double p = orbit_semi_latus_rectum(orbit);
-    double e = orbit_eccentricity(orbit);
+    double x, y, xdot, ydot;
+    orbit_xy_eccentric(orbit, E, &x, &y, &xdot, &ydot);
 
-    return splat4d(eccentric_xdot(mu, p, e, E)) * orbit->major_axis +
-        splat4d(eccentric_ydot(mu, p, e, E)) * orbit->minor_axis;
+    return splat4d(xdot) * orbit->major_axis + splat4d(ydot) * orbit->minor_axis;
 }
 
 #endif
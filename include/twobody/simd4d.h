@@ -6,6 +6,7 @@
 #include <float.h>
 
 typedef double vec4d __attribute__((vector_size(4 * sizeof(double))));
+typedef long vec4l __attribute__((vector_size(4 * sizeof(long))));
 
 static inline vec4d splat4d(double x) __attribute__((always_inline));
 static inline vec4d splat4d(double x) {
@@ -90,6 +91,34 @@ static inline vec4d unit4d(vec4d a) {
     return a / mag4d(a);
 }
 
+static inline vec4d load4d(const double *ptr) __attribute__((always_inline));
+static inline vec4d load4d(const double *ptr) {
+    vec4d x;
+    __builtin_memcpy(&x, ptr, sizeof(x)); // unaligned load
+    return x;
+}
+
+static inline void store4d(double *ptr, vec4d x) __attribute__((always_inline));
+static inline void store4d(double *ptr, vec4d x) {
+    __builtin_memcpy(ptr, &x, sizeof(x)); // unaligned store
+}
+
+// lane-wise mask ? a : b, mask lanes are all ones or all zeros
+static inline vec4d select4d(vec4l mask, vec4d a, vec4d b) __attribute__((always_inline));
+static inline vec4d select4d(vec4l mask, vec4d a, vec4d b) {
+    return (vec4d)((mask & (vec4l)a) | (~mask & (vec4l)b));
+}
+
+static inline int any4l(vec4l mask) __attribute__((always_inline));
+static inline int any4l(vec4l mask) {
+    return (mask[0] | mask[1] | mask[2] | mask[3]) != 0;
+}
+
+static inline int all4l(vec4l mask) __attribute__((always_inline));
+static inline int all4l(vec4l mask) {
+    return (mask[0] & mask[1] & mask[2] & mask[3]) != 0;
+}
+
 static inline int eqv4d(vec4d a, vec4d b) __attribute__((always_inline));
 static inline int eqv4d(vec4d a, vec4d b) {
     double threshold = 1.0e-15; // DBL_EPSILON;
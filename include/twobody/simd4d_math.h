@@ -0,0 +1,244 @@
+#ifndef TWOBODY_SIMD4D_MATH_H
+#define TWOBODY_SIMD4D_MATH_H
+#ifndef TWOBODY_NO_SIMD
+
+#include <twobody/simd4d.h>
+
+#include <math.h>
+#include <float.h>
+
+static inline vec4d abs4d(vec4d x) __attribute__((always_inline));
+static inline vec4d abs4d(vec4d x) {
+    const long m = 0x7fffffffffffffffl; // clear sign bit
+    const vec4l mask = { m, m, m, m };
+    return (vec4d)((vec4l)x & mask);
+}
+
+static inline vec4d sign4d(vec4d x) __attribute__((always_inline));
+static inline vec4d sign4d(vec4d x) {
+    return select4d(x < splat4d(0.0), splat4d(-1.0), splat4d(1.0));
+}
+
+static inline vec4d floor4d(vec4d x) __attribute__((always_inline));
+static inline vec4d floor4d(vec4d x) {
+    return (vec4d){ floor(x[0]), floor(x[1]), floor(x[2]), floor(x[3]) };
+}
+
+// integral doubles to 64 bit integers and back, |x| < 2^51, by adding
+// 1.5*2^52 to shift the integer into the mantissa, AVX2 has no 64 bit
+// conversions and __builtin_convertvector goes lane by lane
+static inline vec4l convert4l(vec4d x) __attribute__((always_inline));
+static inline vec4l convert4l(vec4d x) {
+    const double magic = 6755399441055744.0; // 1.5*2^52
+    return (vec4l)(x + splat4d(magic)) - (vec4l)splat4d(magic);
+}
+
+static inline vec4d convert4d(vec4l x) __attribute__((always_inline));
+static inline vec4d convert4d(vec4l x) {
+    const double magic = 6755399441055744.0; // 1.5*2^52
+    return (vec4d)(x + (vec4l)splat4d(magic)) - splat4d(magic);
+}
+
+static inline vec4d sqrt4d(vec4d x) __attribute__((always_inline));
+static inline vec4d sqrt4d(vec4d x) {
+    return (vec4d){ sqrt(x[0]), sqrt(x[1]), sqrt(x[2]), sqrt(x[3]) };
+}
+
+static inline vec4d cbrt4d(vec4d x) __attribute__((always_inline));
+static inline vec4d cbrt4d(vec4d x) {
+    return (vec4d){ cbrt(x[0]), cbrt(x[1]), cbrt(x[2]), cbrt(x[3]) };
+}
+
+static inline vec4d angle_clamp4d(vec4d x0) __attribute__((always_inline));
+static inline vec4d angle_clamp4d(vec4d x0) {
+    vec4d x = (x0 + splat4d(M_PI)) / splat4d(2.0*M_PI);
+    return splat4d(-M_PI) + splat4d(2.0*M_PI) * (x - floor4d(x));
+}
+
+static inline void sincos4d(vec4d x, vec4d *sinx, vec4d *cosx)
+    __attribute__((always_inline));
+static inline void sincos4d(vec4d x, vec4d *sinx, vec4d *cosx) {
+    // Cody-Waite reduction to |z| <= pi/4 and quadrant q (Cephes sin.c)
+    vec4d q = floor4d(x * splat4d(2.0/M_PI) + splat4d(0.5));
+    vec4d z = ((x - q * splat4d(1.57079625129699707031e+0)) -
+        q * splat4d(7.54978941586159635335e-8)) -
+        q * splat4d(5.39030285815811905290e-15);
+    vec4d zz = z*z;
+
+    vec4d ps = splat4d(1.58962301576546568060e-10);
+    ps = ps*zz + splat4d(-2.50507477628578072866e-8);
+    ps = ps*zz + splat4d(2.75573136213857245213e-6);
+    ps = ps*zz + splat4d(-1.98412698295895385996e-4);
+    ps = ps*zz + splat4d(8.33333333332211858878e-3);
+    ps = ps*zz + splat4d(-1.66666666666666307295e-1);
+    vec4d s = z + z*zz*ps;
+
+    vec4d pc = splat4d(-1.13585365213876817300e-11);
+    pc = pc*zz + splat4d(2.08757008419747316778e-9);
+    pc = pc*zz + splat4d(-2.75573141792967388112e-7);
+    pc = pc*zz + splat4d(2.48015872888517045348e-5);
+    pc = pc*zz + splat4d(-1.38888888888730564116e-3);
+    pc = pc*zz + splat4d(4.16666666666665929218e-2);
+    vec4d c = splat4d(1.0) - splat4d(0.5)*zz + zz*zz*pc;
+
+    // quadrant: 0: (s, c), 1: (c, -s), 2: (-s, -c), 3: (-c, s)
+    vec4l quadrant = convert4l(q);
+    vec4l swap = (quadrant & 1) != 0;
+    vec4l negsin = (quadrant & 2) != 0;
+    vec4l negcos = ((quadrant + 1) & 2) != 0;
+
+    vec4d ss = select4d(swap, c, s), cc = select4d(swap, s, c);
+    *sinx = select4d(negsin, -ss, ss);
+    *cosx = select4d(negcos, -cc, cc);
+}
+
+static inline vec4d ldexp4d(vec4d x, vec4d n) __attribute__((always_inline));
+static inline vec4d ldexp4d(vec4d x, vec4d n) {
+    // x * 2^n, n integral and -1022 <= n <= 1023
+    vec4l bits = (convert4l(n) + 1023) << 52;
+    return x * (vec4d)bits;
+}
+
+static inline vec4d exp4d(vec4d x) __attribute__((always_inline));
+static inline vec4d exp4d(vec4d x) {
+    // Cephes exp.c, x = n*log(2) + r, |r| <= log(2)/2
+    x = select4d(x > splat4d(708.0), splat4d(708.0), x);
+    x = select4d(x < splat4d(-708.0), splat4d(-708.0), x);
+
+    vec4d n = floor4d(x * splat4d(M_LOG2E) + splat4d(0.5));
+    vec4d r = (x - n * splat4d(6.93145751953125e-1)) -
+        n * splat4d(1.42860682030941723212e-6);
+    vec4d rr = r*r;
+
+    vec4d p = splat4d(1.26177193074810590878e-4);
+    p = p*rr + splat4d(3.02994407707441961300e-2);
+    p = p*rr + splat4d(9.99999999999999999910e-1);
+    p = p*r;
+
+    vec4d q = splat4d(3.00198505138664455042e-6);
+    q = q*rr + splat4d(2.52448340349684104192e-3);
+    q = q*rr + splat4d(2.27265548208155028766e-1);
+    q = q*rr + splat4d(2.00000000000000000009e+0);
+
+    vec4d y = splat4d(1.0) + splat4d(2.0) * p / (q - p);
+    return ldexp4d(y, n);
+}
+
+static inline vec4d log4d(vec4d x) __attribute__((always_inline));
+static inline vec4d log4d(vec4d x) {
+    // Cephes log.c, x = m*2^k, sqrt(1/2) <= m < sqrt(2), x positive normal
+    vec4l bits = (vec4l)x;
+    vec4l k = ((bits >> 52) & 0x7ff) - 1022;
+    vec4d m = (vec4d)((bits & 0x800fffffffffffffl) | 0x3fe0000000000000l);
+
+    vec4l small = m < splat4d(M_SQRT1_2);
+    k = k + small; // all ones is -1
+    m = select4d(small, m + m, m) - splat4d(1.0);
+    vec4d kk = convert4d(k);
+
+    vec4d p = splat4d(1.01875663804580931796e-4);
+    p = p*m + splat4d(4.97494994976747001425e-1);
+    p = p*m + splat4d(4.70579119878881725854e+0);
+    p = p*m + splat4d(1.44989225341610930846e+1);
+    p = p*m + splat4d(1.79368678507819816313e+1);
+    p = p*m + splat4d(7.70838733755885391666e+0);
+
+    vec4d q = m + splat4d(1.12873587189167450590e+1);
+    q = q*m + splat4d(4.52279145837532221105e+1);
+    q = q*m + splat4d(8.29875266912776603211e+1);
+    q = q*m + splat4d(7.11544750618563894466e+1);
+    q = q*m + splat4d(2.31251620126765340583e+1);
+
+    vec4d mm = m*m;
+    vec4d y = m * (mm * p / q) - kk * splat4d(2.121944400546905827679e-4);
+    y = y - splat4d(0.5) * mm;
+    return m + y + kk * splat4d(0.693359375);
+}
+
+static inline void sinhcosh4d(vec4d x, vec4d *sinhx, vec4d *coshx)
+    __attribute__((always_inline));
+static inline void sinhcosh4d(vec4d x, vec4d *sinhx, vec4d *coshx) {
+    vec4d ex = exp4d(x), exinv = splat4d(1.0) / ex;
+    *coshx = splat4d(0.5) * (ex + exinv);
+
+    // Taylor series for |x| < 1 (avoid cancellation)
+    vec4d xx = x*x;
+    vec4d p = splat4d(1.0/121645100408832000.0); // 1/19!
+    p = p*xx + splat4d(1.0/355687428096000.0);
+    p = p*xx + splat4d(1.0/1307674368000.0);
+    p = p*xx + splat4d(1.0/6227020800.0);
+    p = p*xx + splat4d(1.0/39916800.0);
+    p = p*xx + splat4d(1.0/362880.0);
+    p = p*xx + splat4d(1.0/5040.0);
+    p = p*xx + splat4d(1.0/120.0);
+    p = p*xx + splat4d(1.0/6.0);
+    vec4d series = x + x*xx*p;
+
+    *sinhx = select4d(abs4d(x) < splat4d(1.0),
+        series, splat4d(0.5) * (ex - exinv));
+}
+
+static inline vec4d atan4d(vec4d x) __attribute__((always_inline));
+static inline vec4d atan4d(vec4d x) {
+    // Cephes atan.c, reduce |x| to 0..0.66 with pi/2 and pi/4 offsets
+    vec4d s = sign4d(x);
+    x = abs4d(x);
+
+    vec4l big = x > splat4d(2.41421356237309504880); // tan(3pi/8)
+    vec4l mid = ~big & (x > splat4d(0.66));
+    vec4d y = select4d(big, splat4d(M_PI_2), select4d(mid, splat4d(M_PI_4), splat4d(0.0)));
+    vec4d more = select4d(big, splat4d(6.123233995736765886130e-17),
+        select4d(mid, splat4d(0.5 * 6.123233995736765886130e-17), splat4d(0.0)));
+    x = select4d(big, splat4d(-1.0) / x,
+        select4d(mid, (x - splat4d(1.0)) / (x + splat4d(1.0)), x));
+
+    vec4d z = x*x;
+    vec4d p = splat4d(-8.750608600031904122785e-1);
+    p = p*z + splat4d(-1.615753718733365076637e+1);
+    p = p*z + splat4d(-7.500855792314704667340e+1);
+    p = p*z + splat4d(-1.228866684490136173410e+2);
+    p = p*z + splat4d(-6.485021904942025371773e+1);
+
+    vec4d q = z + splat4d(2.485846490142306297962e+1);
+    q = q*z + splat4d(1.650270098316988542046e+2);
+    q = q*z + splat4d(4.328810604912902668951e+2);
+    q = q*z + splat4d(4.853903996359136964868e+2);
+    q = q*z + splat4d(1.945506571482613964425e+2);
+
+    return s * (y + (x + x*z*p/q + more));
+}
+
+static inline vec4d atan2_4d(vec4d y, vec4d x) __attribute__((always_inline));
+static inline vec4d atan2_4d(vec4d y, vec4d x) {
+    // atan of min/max in 0..1 (no division by zero), then the octant
+    vec4d ax = abs4d(x), ay = abs4d(y);
+    vec4d hi = select4d(ay > ax, ay, ax), lo = select4d(ay > ax, ax, ay);
+    vec4d t = atan4d(lo / select4d(hi > splat4d(0.0), hi, splat4d(1.0)));
+
+    t = select4d(ay > ax, splat4d(M_PI_2) - t, t);
+    t = select4d(x < splat4d(0.0), splat4d(M_PI) - t, t);
+    return select4d(y < splat4d(0.0), -t, t);
+}
+
+static inline vec4d atanh4d(vec4d x) __attribute__((always_inline));
+static inline vec4d atanh4d(vec4d x) {
+    // |x| < 1, log form loses relative precision near zero: Taylor series
+    vec4d xx = x*x;
+    vec4d p = splat4d(1.0/17.0);
+    p = p*xx + splat4d(1.0/15.0);
+    p = p*xx + splat4d(1.0/13.0);
+    p = p*xx + splat4d(1.0/11.0);
+    p = p*xx + splat4d(1.0/9.0);
+    p = p*xx + splat4d(1.0/7.0);
+    p = p*xx + splat4d(1.0/5.0);
+    p = p*xx + splat4d(1.0/3.0);
+    vec4d series = x + x*xx*p;
+
+    vec4d ratio = (splat4d(1.0) + x) / (splat4d(1.0) - x);
+    vec4d logform = splat4d(0.5) * log4d(select4d(ratio > splat4d(0.0), ratio, splat4d(1.0)));
+
+    return select4d(abs4d(x) < splat4d(0.1), series, logform);
+}
+
+#endif
+#endif
@@ -0,0 +1,111 @@
+#ifndef TWOBODY_SIMD8F_H
+#define TWOBODY_SIMD8F_H
+#ifndef TWOBODY_NO_SIMD
+
+#include <math.h>
+#include <float.h>
+
+// single precision, twice the lanes of vec4d in the same register width
+typedef float vec8f __attribute__((vector_size(8 * sizeof(float))));
+typedef int vec8i __attribute__((vector_size(8 * sizeof(int))));
+
+static inline vec8f splat8f(float x) __attribute__((always_inline));
+static inline vec8f splat8f(float x) {
+    return (vec8f){ x, x, x, x, x, x, x, x };
+}
+
+static inline vec8f load8f(const float *ptr) __attribute__((always_inline));
+static inline vec8f load8f(const float *ptr) {
+    vec8f x;
+    __builtin_memcpy(&x, ptr, sizeof(x)); // unaligned load
+    return x;
+}
+
+static inline void store8f(float *ptr, vec8f x) __attribute__((always_inline));
+static inline void store8f(float *ptr, vec8f x) {
+    __builtin_memcpy(ptr, &x, sizeof(x)); // unaligned store
+}
+
+// lane-wise mask ? a : b, mask lanes are all ones or all zeros
+static inline vec8f select8f(vec8i mask, vec8f a, vec8f b) __attribute__((always_inline));
+static inline vec8f select8f(vec8i mask, vec8f a, vec8f b) {
+    return (vec8f)((mask & (vec8i)a) | (~mask & (vec8i)b));
+}
+
+static inline int any8i(vec8i mask) __attribute__((always_inline));
+static inline int any8i(vec8i mask) {
+    return (mask[0] | mask[1] | mask[2] | mask[3] |
+        mask[4] | mask[5] | mask[6] | mask[7]) != 0;
+}
+
+static inline int all8i(vec8i mask) __attribute__((always_inline));
+static inline int all8i(vec8i mask) {
+    return (mask[0] & mask[1] & mask[2] & mask[3] &
+        mask[4] & mask[5] & mask[6] & mask[7]) != 0;
+}
+
+static inline vec8f abs8f(vec8f x) __attribute__((always_inline));
+static inline vec8f abs8f(vec8f x) {
+    const int m = 0x7fffffff; // clear sign bit
+    const vec8i mask = { m, m, m, m, m, m, m, m };
+    return (vec8f)((vec8i)x & mask);
+}
+
+static inline vec8f sign8f(vec8f x) __attribute__((always_inline));
+static inline vec8f sign8f(vec8f x) {
+    return select8f(x < splat8f(0.0f), splat8f(-1.0f), splat8f(1.0f));
+}
+
+static inline vec8f floor8f(vec8f x) __attribute__((always_inline));
+static inline vec8f floor8f(vec8f x) {
+    // truncate and round down negative lanes, |x| < 2^31
+    vec8f t = __builtin_convertvector(__builtin_convertvector(x, vec8i), vec8f);
+    return select8f(t > x, t - splat8f(1.0f), t);
+}
+
+static inline vec8f sqrt8f(vec8f x) __attribute__((always_inline));
+static inline vec8f sqrt8f(vec8f x) {
+    return (vec8f){
+        sqrtf(x[0]), sqrtf(x[1]), sqrtf(x[2]), sqrtf(x[3]),
+        sqrtf(x[4]), sqrtf(x[5]), sqrtf(x[6]), sqrtf(x[7]) };
+}
+
+static inline vec8f angle_clamp8f(vec8f x0) __attribute__((always_inline));
+static inline vec8f angle_clamp8f(vec8f x0) {
+    vec8f x = (x0 + splat8f(M_PI)) / splat8f(2.0*M_PI);
+    return splat8f(-M_PI) + splat8f(2.0*M_PI) * (x - floor8f(x));
+}
+
+static inline void sincos8f(vec8f x, vec8f *sinx, vec8f *cosx)
+    __attribute__((always_inline));
+static inline void sincos8f(vec8f x, vec8f *sinx, vec8f *cosx) {
+    // Cody-Waite reduction to |z| <= pi/4 and quadrant q (Cephes sinf.c)
+    vec8f q = floor8f(x * splat8f(2.0/M_PI) + splat8f(0.5f));
+    vec8f z = ((x - q * splat8f(1.5703125f)) -
+        q * splat8f(4.837512969970703125e-4f)) -
+        q * splat8f(7.54978995489188216e-8f);
+    vec8f zz = z*z;
+
+    vec8f ps = splat8f(-1.9515295891e-4f);
+    ps = ps*zz + splat8f(8.3321608736e-3f);
+    ps = ps*zz + splat8f(-1.6666654611e-1f);
+    vec8f s = z + z*zz*ps;
+
+    vec8f pc = splat8f(2.443315711809948e-5f);
+    pc = pc*zz + splat8f(-1.388731625493765e-3f);
+    pc = pc*zz + splat8f(4.166664568298827e-2f);
+    vec8f c = splat8f(1.0f) - splat8f(0.5f)*zz + zz*zz*pc;
+
+    // quadrant: 0: (s, c), 1: (c, -s), 2: (-s, -c), 3: (-c, s)
+    vec8i quadrant = __builtin_convertvector(q, vec8i);
+    vec8i swap = (quadrant & 1) != 0;
+    vec8i negsin = (quadrant & 2) != 0;
+    vec8i negcos = ((quadrant + 1) & 2) != 0;
+
+    vec8f ss = select8f(swap, c, s), cc = select8f(swap, s, c);
+    *sinx = select8f(negsin, -ss, ss);
+    *cosx = select8f(negcos, -cc, cc);
+}
+
+#endif
+#endif
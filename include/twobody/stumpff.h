@@ -1,6 +1,8 @@
 #ifndef TWOBODY_STUMPFF_H
 #define TWOBODY_STUMPFF_H
 
+#include <stddef.h>
+
 double stumpff_c0(double z);
 double stumpff_c1(double z);
 double stumpff_c2(double z);
@@ -14,6 +16,72 @@ double stumpff_dc3dz(double z);
 double stumpff_series(int k, double z);
 double stumpff_series_dcdz(int k, double z);
 
+// c0..c3 from piecewise polynomials for |z| < 64 (one revolution is
+// z = 4 pi^2), fixed latency and about 1 ulp there, except near the zeros
+// of c2 at z = (2 pi k)^2, where the error is about 1 ulp of the largest c2
+// nearby (50 ulp at z = 39.2). Larger |z| is divided by 4^n and doubled
+// back, n more steps and error growing with n (300 ulp for |z| < 1e4)
 void stumpff_fast(double z, double *cs);
+// series for |z| < 1/4 and doubling, latency grows with the largest |z|
+void stumpff_fast_n(const double *z, double *cs, size_t n); // cs[4*i + k]
+// c0..c3 and dc0/dz..dc3/dz in a single pass
+void stumpff_fast_with_derivatives(double z, double *cs, double *dcs);
+
+#ifndef TWOBODY_NO_SIMD
+#include <twobody/simd4d.h>
+
+// 1/(k + 2i)!, k = 2 and 3, 8 terms of the series are enough for |z| < 1/4
+static const double stumpff_c2_coeffs[8] = {
+    1.0/2.0, 1.0/24.0, 1.0/720.0, 1.0/40320.0,
+    1.0/3628800.0, 1.0/479001600.0, 1.0/87178291200.0,
+    1.0/20922789888000.0 };
+static const double stumpff_c3_coeffs[8] = {
+    1.0/6.0, 1.0/120.0, 1.0/5040.0, 1.0/362880.0,
+    1.0/39916800.0, 1.0/6227020800.0, 1.0/1307674368000.0,
+    1.0/355687428096000.0 };
+
+static inline vec4d stumpff_series4d(const double *coeffs, vec4d z)
+    __attribute__((always_inline));
+static inline vec4d stumpff_series4d(const double *coeffs, vec4d z) {
+    vec4d c = splat4d(coeffs[7]);
+    for(int i = 6; i >= 0; --i)
+        c = c * -z + splat4d(coeffs[i]);
+    return c;
+}
+
+static inline void stumpff_fast4d(vec4d z, vec4d *cs)
+    __attribute__((always_inline));
+static inline void stumpff_fast4d(vec4d z, vec4d *cs) {
+    // see stumpff_fast, lanes with fewer reductions stop doubling early
+    // reduce to |z| < 1/4 and sum the series, gathering table coefficients
+    // lane by lane is slower than the extra doubling steps
+    vec4l k = (((vec4l)z >> 52) & 0x7ff) - 1023;
+    vec4l n = (k + 4) >> 1;
+    n = n & (n > 0);
+    n = n - ((n - 511) & (n > 511));
+
+    z = z * (vec4d)((1023 - 2*n) << 52); // z / 4^n
+
+    vec4d c2 = stumpff_series4d(stumpff_c2_coeffs, z);
+    vec4d c3 = stumpff_series4d(stumpff_c3_coeffs, z);
+    vec4d c1 = splat4d(1.0) - z*c3;
+    vec4d c0 = splat4d(1.0) - z*c2;
+
+    long max_n = n[0];
+    for(int lane = 1; lane < 4; ++lane)
+        max_n = n[lane] > max_n ? n[lane] : max_n;
+
+    for(long step = 0; step < max_n; ++step) {
+        vec4l active = (vec4l){ step, step, step, step } < n;
+
+        c3 = select4d(active, (c2 + c0*c3) * splat4d(0.25), c3);
+        c2 = select4d(active, c1*c1 * splat4d(0.5), c2);
+        c1 = select4d(active, c0*c1, c1);
+        c0 = select4d(active, splat4d(2.0) * c0*c0 - splat4d(1.0), c0);
+    }
+
+    cs[0] = c0; cs[1] = c1; cs[2] = c2; cs[3] = c3;
+}
+#endif
 
 #endif
@@ -19,6 +19,32 @@ double true_y(double p, double e, double f);
 double true_xdot(double mu, double p, double e, double f);
 double true_ydot(double mu, double p, double e, double f);
 
+// true_x, true_y, true_xdot and true_ydot from one sin/cos
+void true_state_2d(
+    double mu, double p, double e,
+    double f,
+    double *x, double *y,
+    double *xdot, double *ydot);
+
+// kernel of true_state_2d and the orbit state functions, k = sqrt(mu / p),
+// true_state_xy4d in orbit.h is the same for 4 anomalies
+static inline void true_state_xy(
+    double p, double e, double k,
+    double cos_f, double sin_f,
+    double *x, double *y, double *xdot, double *ydot)
+    __attribute__((always_inline));
+static inline void true_state_xy(
+    double p, double e, double k,
+    double cos_f, double sin_f,
+    double *x, double *y, double *xdot, double *ydot) {
+    double r = p / (1.0 + e * cos_f);
+
+    *x = r * cos_f;
+    *y = r * sin_f;
+    *xdot = -k * sin_f;
+    *ydot = k * (e + cos_f);
+}
+
 double true_f(double mu, double p, double r0, double r, double df);
 double true_g(double mu, double p, double r0, double r, double df);
 double true_fdot(double mu, double p, double r0, double r, double df);
@@ -3,6 +3,7 @@
 
 #include <twobody/conic.h>
 #include <twobody/anomaly.h>
+#include <twobody/kepler.h>
 #include <twobody/true_anomaly.h>
 #include <twobody/eccentric_anomaly.h>
 #include <twobody/orientation.h>
@@ -13,4 +14,14 @@
 
 const char *twobody_version();
 
+// time the Kepler solvers on this host and install the fastest one that
+// agrees with the default solver to 1e-12 (scalar and batch), over the
+// workload e and M or built-in elliptic samples when e or M is NULL, the
+// choice applies to hyperbolic orbits too
+// the choice is cached in cache_path (NULL for none) for the same version,
+// CPU (x86 cpuid) and samples, remove the file to tune again
+enum anomaly_solver twobody_autotune(
+    const double *e, const double *M, size_t n,
+    const char *cache_path);
+
 #endif
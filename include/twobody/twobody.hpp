@@ -0,0 +1,522 @@
+#ifndef TWOBODY_TWOBODY_HPP
+#define TWOBODY_TWOBODY_HPP
+
+// Optional header-only C++ layer over libtwobody. Conic type and scalar or
+// vector width are template parameters, the kernels are inlined without
+// classification branches. Same formulas and names as the C functions,
+// e.g. twobody::eccentric_x<twobody::elliptic>(p, e, E) with T one of
+// double, float, vec4d or vec8f. The C API is unchanged and still usable.
+//
+// Mixing conic types in one vector is not possible, the caller classifies
+// (e.g. a catalog that is known to be all elliptic).
+
+#include <cmath>
+#include <cfloat>
+
+extern "C" {
+#include <twobody/twobody.h>
+#ifndef TWOBODY_NO_SIMD
+#include <twobody/simd4d_math.h>
+#include <twobody/simd8f.h>
+#endif
+}
+
+namespace twobody {
+
+// conic type tags
+struct elliptic {};
+struct parabolic {};
+struct hyperbolic {};
+
+namespace detail {
+
+template <typename T> inline T splat(double x) { return T(x); }
+#ifndef TWOBODY_NO_SIMD
+template <> inline vec4d splat<vec4d>(double x) { return splat4d(x); }
+template <> inline vec8f splat<vec8f>(double x) { return splat8f(x); }
+#endif
+
+// scalar overloads from <cmath>, vector ones from the kernels of
+// simd4d_math.h and simd8f.h, vec8f in two vec4d halves where simd8f.h has
+// none
+inline double sin(double x) { return std::sin(x); }
+inline float sin(float x) { return std::sin(x); }
+inline double cos(double x) { return std::cos(x); }
+inline float cos(float x) { return std::cos(x); }
+inline double sinh(double x) { return std::sinh(x); }
+inline float sinh(float x) { return std::sinh(x); }
+inline double cosh(double x) { return std::cosh(x); }
+inline float cosh(float x) { return std::cosh(x); }
+inline double tanh(double x) { return std::tanh(x); }
+inline float tanh(float x) { return std::tanh(x); }
+inline double asinh(double x) { return std::asinh(x); }
+inline float asinh(float x) { return std::asinh(x); }
+inline double atan(double x) { return std::atan(x); }
+inline float atan(float x) { return std::atan(x); }
+inline double sqrt(double x) { return std::sqrt(x); }
+inline float sqrt(float x) { return std::sqrt(x); }
+inline double cbrt(double x) { return std::cbrt(x); }
+inline float cbrt(float x) { return std::cbrt(x); }
+inline double exp(double x) { return std::exp(x); }
+inline float exp(float x) { return std::exp(x); }
+inline double log(double x) { return std::log(x); }
+inline float log(float x) { return std::log(x); }
+inline double floor(double x) { return std::floor(x); }
+inline float floor(float x) { return std::floor(x); }
+inline double atan2(double y, double x) { return std::atan2(y, x); }
+inline float atan2(float y, float x) { return std::atan2(y, x); }
+
+template <typename T> inline void sincos(T x, T *s, T *c) {
+    *s = sin(x);
+    *c = cos(x);
+}
+
+template <typename T> inline void sinhcosh(T x, T *s, T *c) {
+    *s = sinh(x);
+    *c = cosh(x);
+}
+
+inline bool any(bool mask) { return mask; }
+
+#ifndef TWOBODY_NO_SIMD
+inline void sincos(vec4d x, vec4d *s, vec4d *c) { sincos4d(x, s, c); }
+inline void sinhcosh(vec4d x, vec4d *s, vec4d *c) { sinhcosh4d(x, s, c); }
+
+inline vec4d sin(vec4d x) { vec4d s, c; sincos4d(x, &s, &c); return s; }
+inline vec4d cos(vec4d x) { vec4d s, c; sincos4d(x, &s, &c); return c; }
+inline vec4d sinh(vec4d x) { vec4d s, c; sinhcosh4d(x, &s, &c); return s; }
+inline vec4d cosh(vec4d x) { vec4d s, c; sinhcosh4d(x, &s, &c); return c; }
+inline vec4d tanh(vec4d x) { vec4d s, c; sinhcosh4d(x, &s, &c); return s / c; }
+inline vec4d atan(vec4d x) { return atan4d(x); }
+inline vec4d atan2(vec4d y, vec4d x) { return atan2_4d(y, x); }
+inline vec4d sqrt(vec4d x) { return sqrt4d(x); }
+inline vec4d cbrt(vec4d x) { return cbrt4d(x); }
+inline vec4d exp(vec4d x) { return exp4d(x); }
+inline vec4d log(vec4d x) { return log4d(x); }
+inline vec4d floor(vec4d x) { return floor4d(x); }
+
+inline vec4d asinh(vec4d x) {
+    // the log form cancels below 1 (atanh form there), x*x overflows
+    // above 1e150 (log(2|x|) there)
+    vec4d ax = abs4d(x), s = sqrt4d(ax*ax + splat4d(1.0));
+    vec4d y = select4d(ax < splat4d(1.0), atanh4d(ax / s), log4d(ax + s));
+    y = select4d(ax > splat4d(1.0e150), log4d(ax) + splat4d(M_LN2), y);
+    return sign4d(x) * y;
+}
+
+inline bool any(vec4l mask) { return any4l(mask); }
+
+inline vec4d low4d(vec8f x) { return (vec4d){ x[0], x[1], x[2], x[3] }; }
+inline vec4d high4d(vec8f x) { return (vec4d){ x[4], x[5], x[6], x[7] }; }
+inline vec8f join8f(vec4d lo, vec4d hi) {
+    return (vec8f){
+        (float)lo[0], (float)lo[1], (float)lo[2], (float)lo[3],
+        (float)hi[0], (float)hi[1], (float)hi[2], (float)hi[3] };
+}
+
+inline void sincos(vec8f x, vec8f *s, vec8f *c) { sincos8f(x, s, c); }
+inline void sinhcosh(vec8f x, vec8f *s, vec8f *c) {
+    vec4d slo, clo, shi, chi;
+    sinhcosh4d(low4d(x), &slo, &clo);
+    sinhcosh4d(high4d(x), &shi, &chi);
+    *s = join8f(slo, shi);
+    *c = join8f(clo, chi);
+}
+
+inline vec8f sin(vec8f x) { vec8f s, c; sincos8f(x, &s, &c); return s; }
+inline vec8f cos(vec8f x) { vec8f s, c; sincos8f(x, &s, &c); return c; }
+inline vec8f sinh(vec8f x) { return join8f(sinh(low4d(x)), sinh(high4d(x))); }
+inline vec8f cosh(vec8f x) { return join8f(cosh(low4d(x)), cosh(high4d(x))); }
+inline vec8f tanh(vec8f x) { return join8f(tanh(low4d(x)), tanh(high4d(x))); }
+inline vec8f asinh(vec8f x) { return join8f(asinh(low4d(x)), asinh(high4d(x))); }
+inline vec8f atan(vec8f x) { return join8f(atan4d(low4d(x)), atan4d(high4d(x))); }
+inline vec8f atan2(vec8f y, vec8f x) {
+    return join8f(atan2_4d(low4d(y), low4d(x)), atan2_4d(high4d(y), high4d(x)));
+}
+inline vec8f sqrt(vec8f x) { return sqrt8f(x); }
+inline vec8f cbrt(vec8f x) { return join8f(cbrt4d(low4d(x)), cbrt4d(high4d(x))); }
+inline vec8f exp(vec8f x) { return join8f(exp4d(low4d(x)), exp4d(high4d(x))); }
+inline vec8f log(vec8f x) { return join8f(log4d(low4d(x)), log4d(high4d(x))); }
+inline vec8f floor(vec8f x) { return floor8f(x); }
+
+inline bool any(vec8i mask) { return any8i(mask); }
+#endif
+
+// branch free for scalars and vectors (GCC vector ?: is lane-wise)
+template <typename T> inline T abs(T x) {
+    return x < splat<T>(0.0) ? -x : x;
+}
+
+template <typename T> inline T sign(T x) {
+    return x < splat<T>(0.0) ? splat<T>(-1.0) : splat<T>(1.0);
+}
+
+template <typename T> inline T angle_clamp(T x) {
+    // -pi..pi, see angle_clamp
+    T k = floor((x + splat<T>(M_PI)) * splat<T>(0.5 / M_PI));
+    return x - k * splat<T>(2.0 * M_PI);
+}
+
+// a lane stops when its squared step is below this, same threshold as the
+// C solvers
+template <typename T> inline T epsilon() { return splat<T>(DBL_EPSILON); }
+template <> inline float epsilon<float>() { return FLT_EPSILON; }
+#ifndef TWOBODY_NO_SIMD
+template <> inline vec8f epsilon<vec8f>() { return splat8f(FLT_EPSILON); }
+#endif
+
+template <typename T> inline T laguerre_conway(T f0, T f1, T f2) {
+    const double N = 5.0; // laguerre-conway magic constant
+    T disc = splat<T>((N-1.0)*(N-1.0)) * f1*f1 - splat<T>(N*(N-1.0)) * f0*f2;
+    return splat<T>(-N) * f0 / (f1 + sign(f1) * sqrt(abs(disc)));
+}
+
+// conic quantities, see conic.c
+
+template <typename T> inline T semi_major_axis(elliptic, T p, T e) {
+    return p / (splat<T>(1.0) - e*e);
+}
+template <typename T> inline T semi_major_axis(hyperbolic, T p, T e) {
+    return p / (splat<T>(1.0) - e*e);
+}
+template <typename T> inline T semi_major_axis(parabolic, T, T) {
+    return splat<T>(INFINITY);
+}
+
+template <typename T> inline T semi_minor_axis(elliptic, T p, T e) {
+    return p / sqrt(splat<T>(1.0) - e*e);
+}
+template <typename T> inline T semi_minor_axis(hyperbolic, T p, T e) {
+    return p / sqrt(e*e - splat<T>(1.0));
+}
+template <typename T> inline T semi_minor_axis(parabolic, T, T) {
+    return splat<T>(INFINITY);
+}
+
+template <typename T> inline T mean_motion(elliptic, T mu, T p, T e) {
+    T a = semi_major_axis(elliptic(), p, e);
+    return sqrt(mu / (a*a*a));
+}
+template <typename T> inline T mean_motion(hyperbolic, T mu, T p, T e) {
+    T a = semi_major_axis(hyperbolic(), p, e);
+    return sqrt(mu / -(a*a*a));
+}
+template <typename T> inline T mean_motion(parabolic, T mu, T p, T) {
+    return sqrt(mu / (p*p*p));
+}
+
+// Kepler's equation, see anomaly.c
+
+template <typename T> inline T eccentric_to_mean(elliptic, T e, T E) {
+    return E - e * sin(E);
+}
+template <typename T> inline T eccentric_to_mean(hyperbolic, T e, T E) {
+    return e * sinh(E) - E;
+}
+template <typename T> inline T eccentric_to_mean(parabolic, T, T E) {
+    return E*E*E * splat<T>(1.0/6.0) + E * splat<T>(0.5);
+}
+
+template <typename T> inline T eccentric_to_true(elliptic, T e, T E) {
+    T sinE, cosE;
+    sincos(E, &sinE, &cosE);
+    return atan2(sqrt(splat<T>(1.0) - e*e) * sinE, cosE - e);
+}
+template <typename T> inline T eccentric_to_true(hyperbolic, T e, T E) {
+    T k = sqrt((e + splat<T>(1.0)) / (e - splat<T>(1.0)));
+    return splat<T>(2.0) * atan(k * tanh(E * splat<T>(0.5)));
+}
+template <typename T> inline T eccentric_to_true(parabolic, T, T E) {
+    return splat<T>(2.0) * atan(E);
+}
+
+// anomaly_is_near_parabolic lanes from the C solver, the fixed step counts
+// below are not enough there
+inline double near_parabolic(double e, double M, double E) {
+    return anomaly_is_near_parabolic(e, M) ? anomaly_near_parabolic(e, M, 0) : E;
+}
+inline float near_parabolic(float e, float M, float E) {
+    return near_parabolic(double(e), double(M), double(E));
+}
+template <typename V> inline V near_parabolic(V e, V M, V E) {
+    for(unsigned i = 0; i < sizeof(V) / sizeof(E[0]); ++i)
+        E[i] = near_parabolic(e[i], M[i], E[i]);
+    return E;
+}
+
+// always 6 (elliptic) or 5 (hyperbolic) steps, the worst case over a dense
+// grid of e and M plus one as in anomaly_fixed_steps, a lane stops moving
+// after its first step below epsilon
+template <typename T> inline T mean_to_eccentric(elliptic, T e, T M) {
+    T MM = angle_clamp(M);
+    T E = e > splat<T>(0.9) ? MM + splat<T>(0.85) * e * sign(MM) : MM;
+
+    auto active = MM == MM;
+    for(int step = 0; step < 6; ++step) {
+        T sinE, cosE;
+        sincos(E, &sinE, &cosE);
+        T dE = laguerre_conway(E - e*sinE - MM, splat<T>(1.0) - e*cosE, e*sinE);
+        E = active ? E + dE : E;
+        active = active & (dE*dE >= epsilon<T>());
+    }
+
+    E = E + (M - MM);
+    auto near = abs(e - splat<T>(1.0)) < splat<T>(ANOMALY_NEAR_PARABOLIC);
+    return any(near) ? near_parabolic(e, M, E) : E;
+}
+template <typename T> inline T mean_to_eccentric(hyperbolic, T e, T M) {
+    // anomaly_hyperbolic_guess, odd in M
+    T s = sign(M), Ma = abs(M);
+
+    // asymptotic where the cubic has H > 1, the cubic from M = 0 there
+    // (b*b overflows for large M)
+    auto far = Ma > splat<T>(7.0/6.0) * e - splat<T>(1.0);
+    T a = splat<T>(6.0) * (e - splat<T>(1.0)) / e;
+    T b = far ? splat<T>(0.0) : splat<T>(6.0) * Ma / e;
+    T A = cbrt(b * splat<T>(0.5) + sqrt(b*b * splat<T>(0.25) + a*a*a * splat<T>(1.0/27.0)));
+    T B = a / (splat<T>(3.0) * A);
+    T H = b / (A*A + A*B + B*B);
+    T Hasymptotic = asinh((Ma + log(splat<T>(2.0) * Ma / e + splat<T>(1.85))) / e);
+    H = far ? Hasymptotic : H;
+
+    auto active = Ma == Ma;
+    for(int step = 0; step < 5; ++step) {
+        T sinhH, coshH;
+        sinhcosh(H, &sinhH, &coshH);
+
+        // f0, f1 and f2 over e*cosh(H), f1*f1 would overflow from H ~ 355
+        T k = splat<T>(1.0) / (e*coshH);
+        T dH = laguerre_conway((e*sinhH - H - Ma) * k, splat<T>(1.0) - k, e*sinhH * k);
+        H = active ? H + dH : H;
+        active = active & (dH*dH >= epsilon<T>());
+    }
+
+    H = s * H;
+    auto near = abs(e - splat<T>(1.0)) < splat<T>(ANOMALY_NEAR_PARABOLIC);
+    return any(near) ? near_parabolic(e, M, H) : H;
+}
+template <typename T> inline T mean_to_eccentric(parabolic, T, T M) {
+    // Barker's equation in closed form, odd in M (no cancellation)
+    T x = cbrt(sqrt(splat<T>(9.0) * M*M + splat<T>(1.0)) + splat<T>(3.0) * abs(M));
+    return sign(M) * (x - splat<T>(1.0) / x);
+}
+
+// position and velocity in the orbital plane through the C kernels, double
+// (eccentric_anomaly.h, true_anomaly.h) and vec4d (orbit.h), float and vec8f
+// widened to those, outputs first
+struct true_kernel {
+    static void xy(double p, double e, double k, double cos_f, double sin_f,
+        double *x, double *y, double *xdot, double *ydot) {
+        true_state_xy(p, e, k, cos_f, sin_f, x, y, xdot, ydot);
+    }
+#ifndef TWOBODY_NO_SIMD
+    static void xy(vec4d p, vec4d e, vec4d k, vec4d cos_f, vec4d sin_f,
+        vec4d *x, vec4d *y, vec4d *xdot, vec4d *ydot) {
+        true_state_xy4d(p, e, k, cos_f, sin_f, x, y, xdot, ydot);
+    }
+#endif
+};
+
+struct elliptic_kernel {
+    static void xy(double e, double a, double b, double n, double cosE, double sinE,
+        double *x, double *y, double *xdot, double *ydot) {
+        eccentric_xy_elliptic(e, a, b, n, cosE, sinE, x, y, xdot, ydot);
+    }
+#ifndef TWOBODY_NO_SIMD
+    static void xy(vec4d e, vec4d a, vec4d b, vec4d n, vec4d cosE, vec4d sinE,
+        vec4d *x, vec4d *y, vec4d *xdot, vec4d *ydot) {
+        eccentric_xy_elliptic4d(e, a, b, n, cosE, sinE, x, y, xdot, ydot);
+    }
+#endif
+};
+
+struct hyperbolic_kernel {
+    static void xy(double e, double a, double b, double n, double coshE, double sinhE,
+        double *x, double *y, double *xdot, double *ydot) {
+        eccentric_xy_hyperbolic(e, a, b, n, coshE, sinhE, x, y, xdot, ydot);
+    }
+#ifndef TWOBODY_NO_SIMD
+    static void xy(vec4d e, vec4d a, vec4d b, vec4d n, vec4d coshE, vec4d sinhE,
+        vec4d *x, vec4d *y, vec4d *xdot, vec4d *ydot) {
+        eccentric_xy_hyperbolic4d(e, a, b, n, coshE, sinhE, x, y, xdot, ydot);
+    }
+#endif
+};
+
+struct parabolic_kernel {
+    static void xy(double q, double p, double w, double E,
+        double *x, double *y, double *xdot, double *ydot) {
+        eccentric_xy_parabolic(q, p, w, E, x, y, xdot, ydot);
+    }
+#ifndef TWOBODY_NO_SIMD
+    static void xy(vec4d q, vec4d p, vec4d w, vec4d E,
+        vec4d *x, vec4d *y, vec4d *xdot, vec4d *ydot) {
+        eccentric_xy_parabolic4d(q, p, w, E, x, y, xdot, ydot);
+    }
+#endif
+};
+
+template <typename Kernel, typename T, typename... In>
+inline void kernel_xy(Kernel, T *x, T *y, T *xdot, T *ydot, In... in) {
+    Kernel::xy(in..., x, y, xdot, ydot);
+}
+
+template <typename Kernel, typename... In>
+inline void kernel_xy(Kernel kernel, float *x, float *y, float *xdot, float *ydot,
+    In... in) {
+    double xy[4];
+    kernel_xy(kernel, &xy[0], &xy[1], &xy[2], &xy[3], double(in)...);
+    *x = xy[0];
+    *y = xy[1];
+    *xdot = xy[2];
+    *ydot = xy[3];
+}
+
+#ifndef TWOBODY_NO_SIMD
+template <typename Kernel, typename... In>
+inline void kernel_xy(Kernel kernel, vec8f *x, vec8f *y, vec8f *xdot, vec8f *ydot,
+    In... in) {
+    vec4d lo[4], hi[4];
+    kernel_xy(kernel, &lo[0], &lo[1], &lo[2], &lo[3], low4d(in)...);
+    kernel_xy(kernel, &hi[0], &hi[1], &hi[2], &hi[3], high4d(in)...);
+    *x = join8f(lo[0], hi[0]);
+    *y = join8f(lo[1], hi[1]);
+    *xdot = join8f(lo[2], hi[2]);
+    *ydot = join8f(lo[3], hi[3]);
+}
+#endif
+
+template <typename T> inline void eccentric_xy(
+    elliptic, T mu, T p, T e, T E,
+    T *x, T *y, T *xdot, T *ydot) {
+    T a = semi_major_axis(elliptic(), p, e), b = semi_minor_axis(elliptic(), p, e);
+    T sinE, cosE;
+    sincos(E, &sinE, &cosE);
+    kernel_xy(elliptic_kernel(), x, y, xdot, ydot,
+        e, a, b, sqrt(mu / (a*a*a)), cosE, sinE);
+}
+template <typename T> inline void eccentric_xy(
+    hyperbolic, T mu, T p, T e, T E,
+    T *x, T *y, T *xdot, T *ydot) {
+    T a = semi_major_axis(hyperbolic(), p, e), b = semi_minor_axis(hyperbolic(), p, e);
+    T sinhE, coshE;
+    sinhcosh(E, &sinhE, &coshE);
+    kernel_xy(hyperbolic_kernel(), x, y, xdot, ydot,
+        e, a, b, sqrt(mu / -(a*a*a)), coshE, sinhE);
+}
+template <typename T> inline void eccentric_xy(
+    parabolic, T mu, T p, T, T E,
+    T *x, T *y, T *xdot, T *ydot) {
+    kernel_xy(parabolic_kernel(), x, y, xdot, ydot,
+        p * splat<T>(0.5), p, sqrt(mu / p), E);
+}
+
+template <typename T> inline T eccentric_radius(elliptic, T p, T e, T E) {
+    return semi_major_axis(elliptic(), p, e) * (splat<T>(1.0) - e*cos(E));
+}
+template <typename T> inline T eccentric_radius(hyperbolic, T p, T e, T E) {
+    return semi_major_axis(hyperbolic(), p, e) * (splat<T>(1.0) - e*cosh(E));
+}
+template <typename T> inline T eccentric_radius(parabolic, T p, T, T E) {
+    return p * splat<T>(0.5) * (E*E + splat<T>(1.0));
+}
+
+}
+
+template <typename Conic, typename T>
+inline T conic_semi_major_axis(T p, T e) {
+    return detail::semi_major_axis(Conic(), p, e);
+}
+
+template <typename Conic, typename T>
+inline T conic_semi_minor_axis(T p, T e) {
+    return detail::semi_minor_axis(Conic(), p, e);
+}
+
+template <typename Conic, typename T>
+inline T conic_mean_motion(T mu, T p, T e) {
+    return detail::mean_motion(Conic(), mu, p, e);
+}
+
+template <typename Conic, typename T>
+inline T anomaly_eccentric_to_mean(T e, T E) {
+    return detail::eccentric_to_mean(Conic(), e, E);
+}
+
+template <typename Conic, typename T>
+inline T anomaly_eccentric_to_true(T e, T E) {
+    return detail::eccentric_to_true(Conic(), e, E);
+}
+
+template <typename Conic, typename T>
+inline T anomaly_mean_to_eccentric(T e, T M) {
+    return detail::mean_to_eccentric(Conic(), e, M);
+}
+
+template <typename Conic, typename T>
+inline T anomaly_mean_to_true(T e, T M) {
+    return detail::eccentric_to_true(Conic(), e,
+        detail::mean_to_eccentric(Conic(), e, M));
+}
+
+template <typename Conic, typename T>
+inline T eccentric_radius(T p, T e, T E) {
+    return detail::eccentric_radius(Conic(), p, e, E);
+}
+
+// x, y, xdot and ydot from one sin/cos (sinh/cosh)
+template <typename Conic, typename T>
+inline void eccentric_xy(
+    T mu, T p, T e, T E,
+    T *x, T *y, T *xdot, T *ydot) {
+    detail::eccentric_xy(Conic(), mu, p, e, E, x, y, xdot, ydot);
+}
+
+template <typename Conic, typename T>
+inline T eccentric_x(T p, T e, T E) {
+    T x, y, xdot, ydot;
+    detail::eccentric_xy(Conic(), detail::splat<T>(1.0), p, e, E, &x, &y, &xdot, &ydot);
+    return x;
+}
+
+template <typename Conic, typename T>
+inline T eccentric_y(T p, T e, T E) {
+    T x, y, xdot, ydot;
+    detail::eccentric_xy(Conic(), detail::splat<T>(1.0), p, e, E, &x, &y, &xdot, &ydot);
+    return y;
+}
+
+template <typename Conic, typename T>
+inline T eccentric_xdot(T mu, T p, T e, T E) {
+    T x, y, xdot, ydot;
+    detail::eccentric_xy(Conic(), mu, p, e, E, &x, &y, &xdot, &ydot);
+    return xdot;
+}
+
+template <typename Conic, typename T>
+inline T eccentric_ydot(T mu, T p, T e, T E) {
+    T x, y, xdot, ydot;
+    detail::eccentric_xy(Conic(), mu, p, e, E, &x, &y, &xdot, &ydot);
+    return ydot;
+}
+
+// the true anomaly formulas do not depend on the conic type, the
+// parameter is kept for a uniform interface, see true_anomaly.c
+template <typename Conic, typename T>
+inline T true_radius(T p, T e, T f) {
+    return p / (detail::splat<T>(1.0) + e * detail::cos(f));
+}
+
+template <typename Conic, typename T>
+inline void true_xy(
+    T mu, T p, T e, T f,
+    T *x, T *y, T *xdot, T *ydot) {
+    T sin_f, cos_f;
+    detail::sincos(f, &sin_f, &cos_f);
+    detail::kernel_xy(detail::true_kernel(), x, y, xdot, ydot,
+        p, e, detail::sqrt(mu / p), cos_f, sin_f);
+}
+
+}
+
+#endif
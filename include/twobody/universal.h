@@ -1,6 +1,8 @@
 #ifndef TWOBODY_UNIVERSAL_H
 #define TWOBODY_UNIVERSAL_H
 
+#include <stddef.h>
+
 double universal_alpha(double mu, double r, double v2);
 double universal_period(double mu, double alpha);
 
@@ -72,6 +74,33 @@ double universal_gdot(
     double r,
     double s, const double *cs);
 
+// r, sigma, f, g, fdot and gdot in one pass, out[6] in that order
+void universal_fg(
+    double mu,
+    double r0, double sigma0,
+    double alpha,
+    double s, const double *cs,
+    double *out);
+// out[6*i + k], Stumpff values of alpha[i]*s[i]^2 computed here
+void universal_fg_n(
+    double mu,
+    const double *r0, const double *sigma0,
+    const double *alpha,
+    const double *s,
+    double *out,
+    size_t n);
+
+// default and maximum steps of universal_iterate_s
+#define UNIVERSAL_MAX_STEPS 20
+
+// opt-in step count histogram of universal_iterate_s and the propagators
+// (not _fixed),
+// histogram[k] counts the solves that took k steps, the last of the
+// UNIVERSAL_MAX_STEPS + 1 entries counts longer ones, 0 turns it off,
+// the pointer and counts are shared by all threads, not synchronised: set it
+// only around single-threaded tests and benchmarks
+void universal_set_histogram(unsigned long *histogram);
+
 double universal_guess_s(
     double mu,
     double alpha,
@@ -83,5 +112,33 @@ double universal_iterate_s(
     double r0, double sigma0,
     double s0, double time,
     int max_steps);
+// stop when the squared step is below tol, DBL_EPSILON is full precision
+double universal_iterate_s_tol(
+    double mu,
+    double alpha,
+    double r0, double sigma0,
+    double s0, double time,
+    int max_steps, double tol);
+double universal_iterate_s_fixed(
+    double mu,
+    double alpha,
+    double r0, double sigma0,
+    double s0, double time,
+    int steps);
+
+// state after dt from the state (x, y, z) at time 0, any conic or radial
+// orbit, pos_out and vel_out may be pos and vel
+void universal_propagate(
+    double mu,
+    const double *pos, const double *vel,
+    double dt,
+    double *pos_out, double *vel_out);
+// universal_propagate over arrays of n states, overwritten in place
+void universal_propagate_n(
+    double mu,
+    double *x, double *y, double *z,
+    double *vx, double *vy, double *vz,
+    const double *dt,
+    size_t n);
 
 #endif
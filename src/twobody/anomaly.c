@@ -1,14 +1,43 @@
 #include <twobody/conic.h>
 #include <twobody/anomaly.h>
+#include <twobody/stumpff.h>
 #include <twobody/math_utils.h>
 
+#ifndef TWOBODY_NO_SIMD
+#include <twobody/simd4d.h>
+#include <twobody/simd4d_math.h>
+#include <twobody/simd8f.h>
+#endif
+
 #include <math.h>
 #include <float.h>
+#include <stddef.h>
 
-double anomaly_eccentric_iterate(double e, double M, double E0, int max_steps) {
-    if(max_steps <= 0)
-        max_steps = e < 1.0 ? 10 : 20;
-    double threshold = DBL_EPSILON;
+static enum anomaly_solver anomaly_solver = TWOBODY_ANOMALY_SOLVER;
+
+void anomaly_set_solver(enum anomaly_solver solver) {
+    anomaly_solver = solver;
+}
+
+enum anomaly_solver anomaly_get_solver() {
+    return anomaly_solver;
+}
+
+static unsigned long *anomaly_histogram = 0;
+
+void anomaly_set_histogram(unsigned long *histogram) {
+    anomaly_histogram = histogram;
+}
+
+static void anomaly_count_steps(int steps) {
+    if(steps > ANOMALY_MAX_STEPS)
+        steps = ANOMALY_MAX_STEPS;
+    anomaly_histogram[steps] += 1;
+}
+
+static double anomaly_eccentric_solve(
+    double e, double M, double E0,
+    int max_steps, int fixed, double threshold) {
 
     double Mperiod = 0.0;
     if(conic_elliptic(e)) {
@@ -20,7 +49,8 @@ double anomaly_eccentric_iterate(double e, double M, double E0, int max_steps) {
     }
 
     double E = E0;
-    for(int step = 0; step < max_steps; ++step) {
+    int step = 0;
+    while(step < max_steps) {
         double f0, f1, f2;
 
         if(e < 1.0) { // elliptic
@@ -37,29 +67,821 @@ double anomaly_eccentric_iterate(double e, double M, double E0, int max_steps) {
         double dE = -N * f0 /
             (f1 + sign(f1) * sqrt(fabs(square(N-1.0) * f1*f1 - N*(N-1.0) * f0*f2)));
         E = E + dE;
+        step += 1;
 
-        if(dE*dE < threshold)
+        if(!fixed && dE*dE < threshold)
             break;
     }
 
+    if(anomaly_histogram && !fixed)
+        anomaly_count_steps(step);
+
     return E + Mperiod;
 }
 
+double anomaly_eccentric_iterate(double e, double M, double E0, int max_steps) {
+    return anomaly_eccentric_iterate_tol(e, M, E0, max_steps, DBL_EPSILON);
+}
+
+double anomaly_eccentric_iterate_tol(
+    double e, double M, double E0,
+    int max_steps, double tol) {
+    if(max_steps <= 0)
+        max_steps = e < 1.0 ? 10 : 20;
+    return anomaly_eccentric_solve(e, M, E0, max_steps, 0, tol);
+}
+
+double anomaly_eccentric_iterate_fixed(double e, double M, double E0, int steps) {
+    // no early exit, run time does not depend on convergence
+    return anomaly_eccentric_solve(e, M, E0, steps, 1, 0.0);
+}
+
+double anomaly_hyperbolic_guess(double e, double M) {
+    // hyperbolic anomaly is odd in M
+    double s = sign(M);
+    M = fabs(M);
+
+    // asymptotic: e*sinh(H) = M + H, where the cubic below has H > 1
+    // (M > 7e/6 - 1), b*b would overflow for M above about 1e154
+    if(M > 7.0*e/6.0 - 1.0)
+        return s * asinh((M + log(2.0*M/e + 1.85)) / e);
+
+    // near periapsis: e*H^3/6 + (e-1)*H = M (cubic, one real root)
+    double a = 6.0*(e - 1.0)/e, b = 6.0*M/e;
+    double A = cbrt(b/2.0 + sqrt(b*b/4.0 + a*a*a/27.0));
+    double B = a / (3.0*A);
+    double H = b / (A*A + A*B + B*B); // A - B without cancellation
+
+    return s * H;
+}
+
+static double anomaly_hyperbolic_solve(
+    double e, double M, double H0,
+    int max_steps, int fixed, double threshold) {
+
+    // solve for |M|, hyperbolic anomaly is odd in M
+    double s = sign(M);
+    M = fabs(M);
+
+    double H = s * H0;
+    int step = 0;
+    while(step < max_steps) {
+        double dH;
+
+        if(H > 20.0) {
+            // e*sinh(H) overflows, e^-H is below precision:
+            // e*exp(H)/2 = M + H, Newton's method in logarithmic form
+            double f0 = H - log(2.0 * (M + H) / e);
+            double f1 = 1.0 - 1.0 / (M + H);
+            dH = -f0 / f1;
+        } else {
+            // sinh and cosh from a single expm1, accurate near zero
+            double em1 = expm1(H), ex = em1 + 1.0;
+            double sinhH = 0.5 * (em1 + em1/ex);
+            double coshH = 0.5 * (ex + 1.0/ex);
+
+            double f0 = e*sinhH - H - M;
+            double f1 = e*coshH - 1.0;
+            double f2 = e*sinhH;
+
+            double N = 5.0; // laguerre-conway magic constant
+            dH = -N * f0 /
+                (f1 + sign(f1) * sqrt(fabs(square(N-1.0) * f1*f1 - N*(N-1.0) * f0*f2)));
+        }
+
+        H = H + dH;
+        step += 1;
+
+        if(!fixed && dH*dH < threshold)
+            break;
+    }
+
+    if(anomaly_histogram && !fixed)
+        anomaly_count_steps(step);
+
+    return s * H;
+}
+
+double anomaly_hyperbolic_iterate(double e, double M, double H0, int max_steps) {
+    return anomaly_hyperbolic_iterate_tol(e, M, H0, max_steps, DBL_EPSILON);
+}
+
+double anomaly_hyperbolic_iterate_tol(
+    double e, double M, double H0,
+    int max_steps, double tol) {
+    if(max_steps <= 0)
+        max_steps = 20;
+    return anomaly_hyperbolic_solve(e, M, H0, max_steps, 0, tol);
+}
+
+double anomaly_hyperbolic_iterate_fixed(double e, double M, double H0, int steps) {
+    // no early exit, run time does not depend on convergence
+    return anomaly_hyperbolic_solve(e, M, H0, steps, 1, 0.0);
+}
+
+double anomaly_eccentric_markley(double e, double M) {
+    // Markley, F.L.: Kepler Equation Solver (1995)
+    // elliptic orbits only, constant cost: cbrt, sqrt, sin and cos
+
+    // mean anomaly 0..pi, use symmetry for negative half
+    double MM = angle_clamp(M);
+    double Mperiod = M - MM;
+    double s = sign(MM);
+    M = fabs(MM);
+
+    // rational starter (cubic in E)
+    double pi2 = M_PI*M_PI;
+    double alpha = (3.0*pi2 + 1.6*M_PI*(M_PI - M)/(1.0 + e)) / (pi2 - 6.0);
+    double d = 3.0*(1.0 - e) + alpha*e;
+    double q = 2.0*alpha*d*(1.0 - e) - M*M;
+    double r = 3.0*alpha*d*(d - 1.0 + e)*M + M*M*M;
+    double w = square(cbrt(fabs(r) + sqrt(q*q*q + r*r)));
+    double E = (2.0*r*w / (w*w + w*q + q*q) + M) / d;
+
+    // single fifth order correction
+    double sinE = sin(E), cosE = cos(E);
+    double f0 = E - e*sinE - M;
+    double f1 = 1.0 - e*cosE;
+    double f2 = e*sinE;
+    double f3 = e*cosE;
+    double f4 = -f2;
+
+    double d3 = -f0 / (f1 - 0.5*f0*f2/f1);
+    double d4 = -f0 / (f1 + 0.5*d3*f2 + d3*d3*f3/6.0);
+    double d5 = -f0 /
+        (f1 + 0.5*d4*f2 + d4*d4*f3/6.0 + d4*d4*d4*f4/24.0);
+
+    return s * (E + d5) + Mperiod;
+}
+
+static double anomaly_near_parabolic_solve(
+    double e, double M, double E0, int guess,
+    int max_steps, int fixed, double threshold) {
+    // E - e*sin(E) and e*sinh(H) - H cancel when e ~ 1 and E ~ 0, use
+    //   elliptic:   (1-e)*E + e*E^3*c3(E^2)
+    //   hyperbolic: (e-1)*H + e*H^3*c3(-H^2)
+    double Mperiod = 0.0;
+    if(e < 1.0 && fabs(M) > M_PI) {
+        // only clamp when needed, angle_clamp loses precision near zero
+        double MM = angle_clamp(M);
+        Mperiod = M - MM;
+        M = MM;
+    }
+
+    // eccentric anomaly is odd in M
+    double s = sign(M);
+    M = fabs(M);
+
+    double q = fabs(1.0 - e), zsign = e < 1.0 ? 1.0 : -1.0;
+
+    double E;
+    if(guess) {
+        // same period and half as M
+        E = s * (E0 - Mperiod);
+    } else {
+        // parabolic starter: e*E^3/6 + q*E = M (cubic, one real root)
+        double a = 6.0*q/e, b = 6.0*M/e;
+        double A = cbrt(b/2.0 + sqrt(b*b/4.0 + a*a*a/27.0));
+        double B = a / (3.0*A);
+        E = b / (A*A + A*B + B*B); // A - B without cancellation
+    }
+
+    int step = 0;
+    while(step < max_steps) {
+        double cs[4];
+        stumpff_fast(zsign * E*E, cs);
+
+        double f0 = q*E + e*E*E*E*cs[3] - M;
+        double f1 = q + e*E*E*cs[2];
+        double f2 = zsign * e*E*cs[1];
+
+        double N = 5.0; // laguerre-conway magic constant
+        double dE = -N * f0 /
+            (f1 + sign(f1) * sqrt(fabs(square(N-1.0) * f1*f1 - N*(N-1.0) * f0*f2)));
+        E = E + dE;
+        step += 1;
+
+        // relative threshold, E may be tiny
+        if(!fixed && dE*dE < threshold * E*E)
+            break;
+    }
+
+    if(anomaly_histogram && !fixed)
+        anomaly_count_steps(step);
+
+    if(e < 1.0 && E > M_PI) // rounding at apoapsis, E is 0..pi for M 0..pi
+        E = M_PI;
+
+    return s * E + Mperiod;
+}
+
+double anomaly_near_parabolic(double e, double M, int max_steps) {
+    return anomaly_near_parabolic_tol(e, M, max_steps, DBL_EPSILON);
+}
+
+double anomaly_near_parabolic_tol(double e, double M, int max_steps, double tol) {
+    if(max_steps <= 0)
+        max_steps = 8;
+    return anomaly_near_parabolic_solve(e, M, 0.0, 0, max_steps, 0, tol);
+}
+
+double anomaly_near_parabolic_iterate(double e, double M, double E0, int max_steps) {
+    if(max_steps <= 0)
+        max_steps = 8;
+    return anomaly_near_parabolic_solve(e, M, E0, 1, max_steps, 0, DBL_EPSILON);
+}
+
+double anomaly_near_parabolic_fixed(double e, double M, int steps) {
+    // no early exit, run time does not depend on convergence
+    return anomaly_near_parabolic_solve(e, M, 0.0, 0, steps, 1, 0.0);
+}
+
+int anomaly_is_near_parabolic(double e, double M) {
+    // hyperbolic: H below ~1.5, see anomaly_hyperbolic_guess
+    return fabs(e - 1.0) < ANOMALY_NEAR_PARABOLIC &&
+        (e < 1.0 || fabs(M) < 1.0);
+}
+
+// Series in e for near-circular orbits (Lagrange inversion of Kepler's equation)
+//   E = M + e*sin(M) * sum e^(n-1) q_n(cos M)
+//   f = M + e*sin(M) * sum e^(n-1) r_n(cos M)
+// Row n-1 holds q_n (r_n) as a polynomial in cos(M)^2, times cos(M) for even n.
+// Truncated after e^8: the e^n term of E is at most e^n n^(n-1)/n!, so the
+// omitted terms are below 1.3e-16 for e < 0.01. The largest omitted term
+// max|e^9 q_9(cos M) sin M| is 1.2e-18 (5.2e-18 for f).
+static const double anomaly_eccentric_series_coeffs[8][4] = {
+    { 1.0, 0.0, 0.0, 0.0 },
+    { 1.0, 0.0, 0.0, 0.0 },
+    { -1.0/2.0, 3.0/2.0, 0.0, 0.0 },
+    { -5.0/3.0, 8.0/3.0, 0.0, 0.0 },
+    { 13.0/24.0, -19.0/4.0, 125.0/24.0, 0.0 },
+    { 47.0/15.0, -194.0/15.0, 54.0/5.0, 0.0 },
+    { -541.0/720.0, 1041.0/80.0, -1661.0/48.0, 16807.0/720.0 },
+    { -1957.0/315.0, 4946.0/105.0, -1930.0/21.0, 16384.0/315.0 },
+};
+
+static const double anomaly_true_series_coeffs[8][4] = {
+    { 2.0, 0.0, 0.0, 0.0 },
+    { 5.0/2.0, 0.0, 0.0, 0.0 },
+    { -4.0/3.0, 13.0/3.0, 0.0, 0.0 },
+    { -125.0/24.0, 103.0/12.0, 0.0, 0.0 },
+    { 28.0/15.0, -82.0/5.0, 1097.0/60.0, 0.0 },
+    { 2779.0/240.0, -2897.0/60.0, 1223.0/30.0, 0.0 },
+    { -184.0/63.0, 360.0/7.0, -1931.0/14.0, 47273.0/504.0 },
+    { -208165.0/8064.0, 1326403.0/6720.0, -651359.0/1680.0, 556403.0/2520.0 },
+};
+
+static double anomaly_series(
+    const double (*coeffs)[4],
+    double e, double sinM, double cosM) {
+    double cc = cosM*cosM;
+
+    double p = 0.0;
+    for(int n = 7; n >= 0; --n) {
+        const double *k = coeffs[n];
+        double q = k[0] + cc*(k[1] + cc*(k[2] + cc*k[3]));
+        p = p*e + (n % 2 ? cosM*q : q);
+    }
+
+    return e*sinM*p;
+}
+
+double anomaly_eccentric_series(double e, double M) {
+    // E - M is periodic in M, no range reduction needed
+    return M + anomaly_series(anomaly_eccentric_series_coeffs, e, sin(M), cos(M));
+}
+
+double anomaly_true_series(double e, double M) {
+    // true anomaly -pi..pi, same as anomaly_eccentric_to_true
+    if(fabs(M) > M_PI)
+        M = angle_clamp(M);
+
+    double f = M + anomaly_series(anomaly_true_series_coeffs, e, sin(M), cos(M));
+    return clamp(-M_PI, M_PI, f);
+}
+
+static double anomaly_parabolic(double M) {
+    // parabolic anomaly, Barker's equation in closed form
+    double x = pow(sqrt(9.0*M*M + 1.0) + 3.0*M, 1.0/3.0);
+    return x - 1.0/x;
+}
+
+int anomaly_fixed_steps(double e, double M) {
+    // worst case over a dense grid of e and M (log M for hyperbolic) plus one,
+    // converged to rounding with the starters of anomaly_mean_to_eccentric,
+    // asserted in anomaly_test
+    if(anomaly_is_near_parabolic(e, M))
+        return 5; // elliptic 3, hyperbolic 4
+    if(e < ANOMALY_SERIES)
+        return 0; // series, no iteration
+    if(e < 0.8)
+        return 4;
+    if(e < 0.9)
+        return 5;
+    if(e < 1.0)
+        return 6;
+    return 4; // hyperbolic
+}
+
+double anomaly_mean_to_eccentric_fixed(double e, double M) {
+    // same dispatch as anomaly_mean_to_eccentric, constant step counts
+    if(conic_parabolic(e))
+        return anomaly_parabolic(M);
+
+    int steps = anomaly_fixed_steps(e, M);
+    if(anomaly_is_near_parabolic(e, M))
+        return anomaly_near_parabolic_fixed(e, M, steps);
+
+    if(e < ANOMALY_SERIES)
+        return anomaly_eccentric_series(e, M);
+
+    if(conic_hyperbolic(e))
+        return anomaly_hyperbolic_iterate_fixed(
+            e, M, anomaly_hyperbolic_guess(e, M), steps);
+
+    double E0 = M;
+    if(e > 0.9) // high eccentricity
+        E0 = M + 0.85 * e * sign(angle_clamp(M));
+
+    return anomaly_eccentric_iterate_fixed(e, M, E0, steps);
+}
+
 double anomaly_mean_to_eccentric(double e, double M) {
-    if(conic_parabolic(e)) {
-        // parabolic anomaly
-        double x = pow(sqrt(9.0*M*M + 1.0) + 3.0*M, 1.0/3.0);
-        return x - 1.0/x;
+    return anomaly_mean_to_eccentric_tol(e, M, DBL_EPSILON);
+}
+
+double anomaly_mean_to_eccentric_tol(double e, double M, double tol) {
+    if(conic_parabolic(e))
+        return anomaly_parabolic(M);
+
+    if(anomaly_solver == ANOMALY_SOLVER_FIXED)
+        return anomaly_mean_to_eccentric_fixed(e, M);
+
+    if(anomaly_is_near_parabolic(e, M))
+        return anomaly_near_parabolic_tol(e, M, 0, tol);
+
+    if(e < ANOMALY_SERIES)
+        return anomaly_eccentric_series(e, M);
+
+    if(anomaly_solver == ANOMALY_SOLVER_MARKLEY && conic_elliptic(e))
+        return anomaly_eccentric_markley(e, M);
+
+    if(conic_hyperbolic(e)) {
+        // hyperbolic anomaly
+        double H0 = anomaly_hyperbolic_guess(e, M);
+        return anomaly_hyperbolic_iterate_tol(e, M, H0, 0, tol);
     }
 
     double E0 = M;
-    if(e > 1.0) // hyperbolic orbit
-        E0 = sign(M) * log(2.0 * fabs(M) / e + 1.85);
-    else if(e > 0.9) // high eccentricity
+    if(e > 0.9) // high eccentricity
         E0 = M + 0.85 * e * sign(angle_clamp(M));
 
-    // eccentric or hyperbolic anomaly
-    return anomaly_eccentric_iterate(e, M, E0, 0);
+    // eccentric anomaly
+    return anomaly_eccentric_iterate_tol(e, M, E0, 0, tol);
+}
+
+#ifndef TWOBODY_NO_SIMD
+static vec4d anomaly_eccentric_iterate4d(
+    vec4d e, vec4d M, vec4d E0,
+    int max_steps, int fixed, double threshold) {
+    // elliptic lanes only, see anomaly_eccentric_iterate
+
+    vec4d MM = angle_clamp4d(M);
+    vec4d Mperiod = M - MM;
+    M = MM;
+
+    vec4d E = E0 - Mperiod;
+    vec4l active = { -1, -1, -1, -1 }; // all lanes iterating
+
+    for(int step = 0; step < max_steps; ++step) {
+        vec4d sinE, cosE;
+        sincos4d(E, &sinE, &cosE);
+
+        vec4d f0 = E - e*sinE - M;
+        vec4d f1 = splat4d(1.0) - e*cosE;
+        vec4d f2 = e*sinE;
+
+        const double N = 5.0; // laguerre-conway magic constant
+        vec4d dE = splat4d(-N) * f0 /
+            (f1 + sign4d(f1) * sqrt4d(abs4d(
+                splat4d(square(N-1.0)) * f1*f1 - splat4d(N*(N-1.0)) * f0*f2)));
+
+        // converged lanes keep their value
+        E = E + select4d(active, dE, splat4d(0.0));
+        active = active & (dE*dE >= splat4d(threshold));
+
+        if(!fixed && !any4l(active))
+            break;
+    }
+
+    return E + Mperiod;
+}
+
+static vec4d anomaly_hyperbolic_guess4d(vec4d e, vec4d M) {
+    // hyperbolic lanes only, see anomaly_hyperbolic_guess
+    vec4d s = sign4d(M);
+    M = abs4d(M);
+
+    // the cubic from M = 0 where the asymptotic form is used, no overflow
+    vec4l far = M > splat4d(7.0/6.0) * e - splat4d(1.0);
+    vec4d a = splat4d(6.0) * (e - splat4d(1.0)) / e;
+    vec4d b = select4d(far, splat4d(0.0), splat4d(6.0) * M / e);
+    vec4d A = cbrt4d(b * splat4d(0.5) + sqrt4d(b*b*splat4d(0.25) + a*a*a*splat4d(1.0/27.0)));
+    vec4d B = a / (splat4d(3.0) * A);
+    vec4d H = b / (A*A + A*B + B*B);
+
+    // inf above about 1e154, such lanes are left to the scalar solver
+    vec4d y = (M + log4d(splat4d(2.0) * M / e + splat4d(1.85))) / e;
+    vec4d Hasymptotic = log4d(y + sqrt4d(y*y + splat4d(1.0))); // asinh
+
+    return s * select4d(far, Hasymptotic, H);
+}
+
+static vec4d anomaly_hyperbolic_iterate4d(
+    vec4d e, vec4d M, vec4d H0,
+    int max_steps, int fixed, double threshold) {
+    // hyperbolic lanes with |H| <= 20, see anomaly_hyperbolic_iterate
+
+    vec4d H = H0;
+    vec4l active = { -1, -1, -1, -1 }; // all lanes iterating
+
+    for(int step = 0; step < max_steps; ++step) {
+        vec4d sinhH, coshH;
+        sinhcosh4d(H, &sinhH, &coshH);
+
+        vec4d f0 = e*sinhH - H - M;
+        vec4d f1 = e*coshH - splat4d(1.0);
+        vec4d f2 = e*sinhH;
+
+        const double N = 5.0; // laguerre-conway magic constant
+        vec4d dH = splat4d(-N) * f0 /
+            (f1 + sign4d(f1) * sqrt4d(abs4d(
+                splat4d(square(N-1.0)) * f1*f1 - splat4d(N*(N-1.0)) * f0*f2)));
+
+        H = H + select4d(active, dH, splat4d(0.0));
+        active = active & (dH*dH >= splat4d(threshold));
+
+        if(!fixed && !any4l(active))
+            break;
+    }
+
+    return H;
+}
+
+static vec4d anomaly_eccentric_markley4d(vec4d e, vec4d M) {
+    // elliptic lanes only, see anomaly_eccentric_markley
+    vec4d MM = angle_clamp4d(M);
+    vec4d Mperiod = M - MM;
+    vec4d s = sign4d(MM);
+    M = abs4d(MM);
+
+    const double pi2 = M_PI*M_PI;
+    vec4d one = splat4d(1.0);
+    vec4d alpha = (splat4d(3.0*pi2) +
+        splat4d(1.6*M_PI) * (splat4d(M_PI) - M) / (one + e)) / splat4d(pi2 - 6.0);
+    vec4d d = splat4d(3.0) * (one - e) + alpha*e;
+    vec4d q = splat4d(2.0) * alpha * d * (one - e) - M*M;
+    vec4d r = splat4d(3.0) * alpha * d * (d - one + e) * M + M*M*M;
+    vec4d w = cbrt4d(abs4d(r) + sqrt4d(q*q*q + r*r));
+    w = w*w;
+    vec4d E = (splat4d(2.0) * r * w / (w*w + w*q + q*q) + M) / d;
+
+    vec4d sinE, cosE;
+    sincos4d(E, &sinE, &cosE);
+    vec4d f0 = E - e*sinE - M;
+    vec4d f1 = one - e*cosE;
+    vec4d f2 = e*sinE;
+    vec4d f3 = e*cosE;
+    vec4d f4 = -f2;
+
+    vec4d c2 = splat4d(1.0/2.0), c3 = splat4d(1.0/6.0), c4 = splat4d(1.0/24.0);
+    vec4d d3 = -f0 / (f1 - c2*f0*f2/f1);
+    vec4d d4 = -f0 / (f1 + c2*d3*f2 + c3*d3*d3*f3);
+    vec4d d5 = -f0 /
+        (f1 + c2*d4*f2 + c3*d4*d4*f3 + c4*d4*d4*d4*f4);
+
+    return s * (E + d5) + Mperiod;
+}
+
+static vec4d anomaly_eccentric_series4d(vec4d e, vec4d M) {
+    // see anomaly_eccentric_series
+    vec4d sinM, cosM;
+    sincos4d(M, &sinM, &cosM);
+    vec4d cc = cosM*cosM;
+
+    vec4d p = splat4d(0.0);
+    for(int n = 7; n >= 0; --n) {
+        const double *k = anomaly_eccentric_series_coeffs[n];
+        vec4d q = splat4d(k[0]) +
+            cc*(splat4d(k[1]) + cc*(splat4d(k[2]) + cc*splat4d(k[3])));
+        p = p*e + (n % 2 ? cosM*q : q);
+    }
+
+    return M + e*sinM*p;
+}
+
+static int anomaly_fixed_steps4(const double *e, const double *M) {
+    // most steps of any lane
+    int steps = 0;
+    for(int lane = 0; lane < 4; ++lane)
+        if(anomaly_fixed_steps(e[lane], M[lane]) > steps)
+            steps = anomaly_fixed_steps(e[lane], M[lane]);
+    return steps;
+}
+#endif
+
+void anomaly_mean_to_eccentric_n(
+    const double *e, const double *M,
+    double *E,
+    size_t n) {
+    anomaly_mean_to_eccentric_n_tol(e, M, E, n, DBL_EPSILON);
+}
+
+void anomaly_mean_to_eccentric_n_tol(
+    const double *e, const double *M,
+    double *E,
+    size_t n,
+    double tol) {
+    size_t i = 0;
+
+#ifndef TWOBODY_NO_SIMD
+    // fixed steps ignore tol and keep every lane iterating, as the scalar
+    // anomaly_mean_to_eccentric_fixed does
+    int fixed = anomaly_solver == ANOMALY_SOLVER_FIXED;
+    double threshold = fixed ? 0.0 : tol;
+
+    for(; i + 4 <= n; i += 4) {
+        vec4d ee = load4d(e + i), MM = load4d(M + i);
+
+        vec4l parabolic = (ee - splat4d(1.0)) * (ee - splat4d(1.0)) <
+            splat4d(DBL_EPSILON);
+        vec4l near_parabolic =
+            (abs4d(ee - splat4d(1.0)) < splat4d(ANOMALY_NEAR_PARABOLIC)) &
+            ((ee < splat4d(1.0)) | (abs4d(MM) < splat4d(1.0)));
+        vec4l elliptic = ~parabolic & ~near_parabolic & (ee < splat4d(1.0));
+        vec4l hyperbolic = ~parabolic & ~near_parabolic & (ee > splat4d(1.0));
+
+        if(all4l(hyperbolic)) {
+            vec4d H0 = anomaly_hyperbolic_guess4d(ee, MM);
+
+            if(all4l(abs4d(H0) <= splat4d(20.0))) { // no overflow
+                store4d(E + i, anomaly_hyperbolic_iterate4d(
+                    ee, MM, H0, fixed ? anomaly_fixed_steps4(e + i, M + i) : 20,
+                    fixed, threshold));
+                continue;
+            }
+        }
+
+        if(!all4l(elliptic)) { // mixed or near-parabolic, lanes one by one
+            for(int lane = 0; lane < 4; ++lane)
+                E[i + lane] = anomaly_mean_to_eccentric_tol(
+                    e[i + lane], M[i + lane], tol);
+            continue;
+        }
+
+        vec4l series = ee < splat4d(ANOMALY_SERIES);
+        if(all4l(series)) {
+            store4d(E + i, anomaly_eccentric_series4d(ee, MM));
+            continue;
+        }
+
+        vec4d EE;
+        if(anomaly_solver == ANOMALY_SOLVER_MARKLEY) {
+            EE = anomaly_eccentric_markley4d(ee, MM);
+        } else {
+            // initial guess, same as anomaly_mean_to_eccentric
+            vec4d E0 = select4d(ee > splat4d(0.9),
+                MM + splat4d(0.85) * ee * sign4d(angle_clamp4d(MM)),
+                MM);
+
+            int steps = fixed ? anomaly_fixed_steps4(e + i, M + i) : 10;
+
+            EE = anomaly_eccentric_iterate4d(ee, MM, E0, steps, fixed, threshold);
+        }
+
+        if(any4l(series))
+            EE = select4d(series, anomaly_eccentric_series4d(ee, MM), EE);
+
+        store4d(E + i, EE);
+    }
+#endif
+
+    for(; i < n; ++i)
+        E[i] = anomaly_mean_to_eccentric_tol(e[i], M[i], tol);
+}
+
+float anomaly_mean_to_eccentric_f(float e, float M) {
+    // single precision, see anomaly_mean_to_eccentric
+    const float threshold = FLT_EPSILON;
+    const float N = 5.0f; // laguerre-conway magic constant
+
+    if(conic_parabolic(e)) {
+        // parabolic anomaly, odd in M (no cancellation for M < 0)
+        float x = cbrtf(sqrtf(9.0f*M*M + 1.0f) + 3.0f*fabsf(M));
+        return (M < 0.0f ? -1.0f : 1.0f) * (x - 1.0f/x);
+    }
+
+    if(e > 1.0f) {
+        // hyperbolic anomaly is odd in M, see anomaly_hyperbolic_guess
+        float s = M < 0.0f ? -1.0f : 1.0f;
+        M = fabsf(M);
+
+        float H;
+        if(M > 7.0f*e/6.0f - 1.0f) { // b*b overflows above 2e19
+            H = asinhf((M + logf(2.0f*M/e + 1.85f)) / e);
+        } else {
+            float a = 6.0f*(e - 1.0f)/e, b = 6.0f*M/e;
+            float A = cbrtf(b/2.0f + sqrtf(b*b/4.0f + a*a*a/27.0f));
+            float B = a / (3.0f*A);
+            H = b / (A*A + A*B + B*B);
+        }
+
+        for(int step = 0; step < 20; ++step) {
+            float dH;
+
+            if(H > 20.0f) { // see anomaly_hyperbolic_iterate
+                float f0 = H - logf(2.0f * (M + H) / e);
+                float f1 = 1.0f - 1.0f / (M + H);
+                dH = -f0 / f1;
+            } else {
+                float em1 = expm1f(H), ex = em1 + 1.0f;
+                float sinhH = 0.5f * (em1 + em1/ex);
+                float coshH = 0.5f * (ex + 1.0f/ex);
+
+                float f0 = e*sinhH - H - M;
+                float f1 = e*coshH - 1.0f;
+                float f2 = e*sinhH;
+                dH = -N * f0 / (f1 + sqrtf(fabsf(
+                    (N-1.0f)*(N-1.0f) * f1*f1 - N*(N-1.0f) * f0*f2)));
+            }
+
+            H = H + dH;
+
+            if(dH*dH < threshold)
+                break;
+        }
+
+        return s * H;
+    }
+
+    // mean anomaly -pi..pi, Mperiod is multiple of 2pi
+    float x = (M + (float)M_PI) / (float)(2.0*M_PI);
+    float MM = (float)-M_PI + (float)(2.0*M_PI) * (x - floorf(x));
+    float Mperiod = M - MM;
+    M = MM;
+
+    float E = e > 0.9f ? M + 0.85f * e * (M < 0.0f ? -1.0f : 1.0f) : M;
+    for(int step = 0; step < 10; ++step) {
+        float sinE = sinf(E), cosE = cosf(E);
+
+        float f0 = E - e*sinE - M;
+        float f1 = 1.0f - e*cosE;
+        float f2 = e*sinE;
+        float dE = -N * f0 / (f1 + sqrtf(fabsf(
+            (N-1.0f)*(N-1.0f) * f1*f1 - N*(N-1.0f) * f0*f2)));
+        E = E + dE;
+
+        if(dE*dE < threshold)
+            break;
+    }
+
+    return E + Mperiod;
+}
+
+#ifndef TWOBODY_NO_SIMD
+static vec8f anomaly_eccentric_iterate8f(vec8f e, vec8f M) {
+    // elliptic lanes only, see anomaly_mean_to_eccentric_f
+    const float threshold = FLT_EPSILON;
+    const float N = 5.0f; // laguerre-conway magic constant
+
+    vec8f MM = angle_clamp8f(M);
+    vec8f Mperiod = M - MM;
+    M = MM;
+
+    vec8f E = select8f(e > splat8f(0.9f),
+        M + splat8f(0.85f) * e * sign8f(M),
+        M);
+    vec8i active = { -1, -1, -1, -1, -1, -1, -1, -1 }; // all lanes iterating
+
+    for(int step = 0; step < 10; ++step) {
+        vec8f sinE, cosE;
+        sincos8f(E, &sinE, &cosE);
+
+        vec8f f0 = E - e*sinE - M;
+        vec8f f1 = splat8f(1.0f) - e*cosE;
+        vec8f f2 = e*sinE;
+
+        vec8f dE = splat8f(-N) * f0 /
+            (f1 + sqrt8f(abs8f(
+                splat8f((N-1.0f)*(N-1.0f)) * f1*f1 - splat8f(N*(N-1.0f)) * f0*f2)));
+
+        E = E + select8f(active, dE, splat8f(0.0f));
+        active = active & (dE*dE >= splat8f(threshold));
+
+        if(!any8i(active))
+            break;
+    }
+
+    return E + Mperiod;
+}
+#endif
+
+void anomaly_mean_to_eccentric_nf(
+    const float *e, const float *M,
+    float *E,
+    size_t n) {
+    size_t i = 0;
+
+#ifndef TWOBODY_NO_SIMD
+    for(; i + 8 <= n; i += 8) {
+        vec8f ee = load8f(e + i);
+
+        // same as conic_parabolic, in single precision
+        vec8i parabolic = (ee - splat8f(1.0f)) * (ee - splat8f(1.0f)) <
+            splat8f(DBL_EPSILON);
+        if(all8i(~parabolic & (ee < splat8f(1.0f)))) {
+            store8f(E + i, anomaly_eccentric_iterate8f(ee, load8f(M + i)));
+            continue;
+        }
+
+        for(int lane = 0; lane < 8; ++lane)
+            E[i + lane] = anomaly_mean_to_eccentric_f(e[i + lane], M[i + lane]);
+    }
+#endif
+
+    for(; i < n; ++i)
+        E[i] = anomaly_mean_to_eccentric_f(e[i], M[i]);
+}
+
+static int anomaly_mixed(double e, double M) {
+    // float guess pays off: not parabolic, near-parabolic (precision) or
+    // near-circular (double series is cheaper), not |M| > 1e18 where the
+    // asymptotic double starter is already exact
+    return !conic_parabolic(e) &&
+        !anomaly_is_near_parabolic(e, M) &&
+        !(e < ANOMALY_SERIES) &&
+        fabs(M) < 1.0e18;
+}
+
+double anomaly_mean_to_eccentric_mixed(double e, double M) {
+    // single precision guess, a single double precision step
+    if(!anomaly_mixed(e, M))
+        return anomaly_mean_to_eccentric(e, M);
+
+    if(conic_hyperbolic(e)) {
+        double H0 = anomaly_mean_to_eccentric_f(e, M);
+        return anomaly_hyperbolic_iterate_fixed(e, M, H0, 1);
+    }
+
+    // reduce in double precision, float M loses the fraction of a period
+    double MM = angle_clamp(M);
+    double E0 = anomaly_mean_to_eccentric_f(e, MM) + (M - MM);
+    return anomaly_eccentric_iterate_fixed(e, M, E0, 1);
+}
+
+void anomaly_mean_to_eccentric_mixed_n(
+    const double *e, const double *M,
+    double *E,
+    size_t n) {
+    size_t i = 0;
+
+#ifndef TWOBODY_NO_SIMD
+    for(; i + 8 <= n; i += 8) {
+        int elliptic = 1;
+        for(int lane = 0; lane < 8; ++lane)
+            elliptic = elliptic && e[i + lane] < 1.0 &&
+                anomaly_mixed(e[i + lane], M[i + lane]);
+
+        if(!elliptic) {
+            for(int lane = 0; lane < 8; ++lane)
+                E[i + lane] = anomaly_mean_to_eccentric_mixed(
+                    e[i + lane], M[i + lane]);
+            continue;
+        }
+
+        vec4d ee[2] = { load4d(e + i), load4d(e + i + 4) };
+        vec4d MM[2] = { load4d(M + i), load4d(M + i + 4) };
+        vec4d Mperiod[2] = {
+            MM[0] - angle_clamp4d(MM[0]),
+            MM[1] - angle_clamp4d(MM[1]) };
+
+        float ef[8], Mf[8], Ef[8];
+        for(int lane = 0; lane < 8; ++lane) {
+            ef[lane] = ee[lane / 4][lane % 4];
+            Mf[lane] = MM[lane / 4][lane % 4] - Mperiod[lane / 4][lane % 4];
+        }
+        store8f(Ef, anomaly_eccentric_iterate8f(load8f(ef), load8f(Mf)));
+
+        for(int h = 0; h < 2; ++h) {
+            vec4d E0 = (vec4d){ Ef[4*h], Ef[4*h + 1], Ef[4*h + 2], Ef[4*h + 3] } +
+                Mperiod[h];
+            store4d(E + i + 4*h, anomaly_eccentric_iterate4d(ee[h], MM[h], E0, 1, 1, 0.0));
+        }
+    }
+#endif
+
+    for(; i < n; ++i)
+        E[i] = anomaly_mean_to_eccentric_mixed(e[i], M[i]);
 }
 
 double anomaly_eccentric_to_mean(double e, double E) {
@@ -94,9 +916,182 @@ double anomaly_true_to_mean(double e, double f) {
 }
 
 double anomaly_mean_to_true(double e, double M) {
+    if(e < ANOMALY_SERIES)
+        return anomaly_true_series(e, M);
+
     return anomaly_eccentric_to_true(e, anomaly_mean_to_eccentric(e, M));
 }
 
+#ifndef TWOBODY_NO_SIMD
+// lane masks of the conic types, see conic_parabolic and conic_hyperbolic
+static void anomaly_conic_masks4d(
+    vec4d e,
+    vec4l *elliptic, vec4l *parabolic, vec4l *hyperbolic) {
+    vec4d em1 = e - splat4d(1.0);
+    *parabolic = em1*em1 < splat4d(DBL_EPSILON);
+    *hyperbolic = ~*parabolic & (e > splat4d(1.0));
+    *elliptic = ~*parabolic & ~*hyperbolic;
+}
+
+static vec4d anomaly_eccentric_to_true4d(vec4d e, vec4d E) {
+    // see anomaly_eccentric_to_true, only the types present are evaluated
+    vec4l elliptic, parabolic, hyperbolic;
+    anomaly_conic_masks4d(e, &elliptic, &parabolic, &hyperbolic);
+    vec4d one = splat4d(1.0), f = splat4d(0.0);
+
+    if(any4l(elliptic)) {
+        vec4d sinE, cosE;
+        sincos4d(E, &sinE, &cosE);
+        vec4d ee = select4d(elliptic, e, splat4d(0.0)); // no NaN in other lanes
+        f = select4d(elliptic, atan2_4d(sqrt4d(one - ee*ee) * sinE, cosE - ee), f);
+    }
+
+    if(any4l(hyperbolic)) {
+        // tanh(E/2) = sinh(E) / (cosh(E) + 1)
+        vec4d sinhE, coshE;
+        sinhcosh4d(E, &sinhE, &coshE);
+        vec4d ee = select4d(hyperbolic, e, splat4d(2.0));
+        vec4d k = sqrt4d((ee + one) / (ee - one));
+        f = select4d(hyperbolic,
+            splat4d(2.0) * atan4d(k * sinhE / (coshE + one)), f);
+    }
+
+    if(any4l(parabolic))
+        f = select4d(parabolic, splat4d(2.0) * atan4d(E), f);
+
+    return f;
+}
+
+static vec4d anomaly_true_to_eccentric4d(vec4d e, vec4d f) {
+    // see anomaly_true_to_eccentric
+    vec4l elliptic, parabolic, hyperbolic;
+    anomaly_conic_masks4d(e, &elliptic, &parabolic, &hyperbolic);
+    vec4d one = splat4d(1.0), E = splat4d(0.0);
+
+    vec4d sin_f, cos_f;
+    sincos4d(f, &sin_f, &cos_f);
+
+    if(any4l(elliptic)) {
+        vec4d ee = select4d(elliptic, e, splat4d(0.0));
+        E = select4d(elliptic, atan2_4d(sqrt4d(one - ee*ee) * sin_f, cos_f + ee), E);
+    }
+
+    if(!all4l(elliptic)) {
+        // tan(f/2) without cancellation near f = 0 and f = pi
+        vec4d tan_half = select4d(cos_f >= splat4d(0.0),
+            sin_f / (one + cos_f), (one - cos_f) / sin_f);
+
+        vec4d ee = select4d(hyperbolic, e, splat4d(2.0));
+        vec4d k = sqrt4d((ee - one) / (ee + one));
+        E = select4d(hyperbolic, splat4d(2.0) * atanh4d(k * tan_half), E);
+        E = select4d(parabolic, tan_half, E);
+    }
+
+    return E;
+}
+
+static vec4d anomaly_eccentric_to_mean4d(vec4d e, vec4d E) {
+    // see anomaly_eccentric_to_mean
+    vec4l elliptic, parabolic, hyperbolic;
+    anomaly_conic_masks4d(e, &elliptic, &parabolic, &hyperbolic);
+    vec4d M = splat4d(0.0);
+
+    if(any4l(elliptic)) {
+        vec4d sinE, cosE;
+        sincos4d(E, &sinE, &cosE);
+        M = select4d(elliptic, E - e*sinE, M);
+    }
+
+    if(any4l(hyperbolic)) {
+        vec4d sinhE, coshE;
+        sinhcosh4d(E, &sinhE, &coshE);
+        M = select4d(hyperbolic, e*sinhE - E, M);
+    }
+
+    if(any4l(parabolic))
+        M = select4d(parabolic, E*E*E * splat4d(1.0/6.0) + E * splat4d(0.5), M);
+
+    return M;
+}
+#endif
+
+void anomaly_eccentric_to_true_n(
+    const double *e, const double *E,
+    double *f,
+    size_t n) {
+    size_t i = 0;
+
+#ifndef TWOBODY_NO_SIMD
+    for(; i + 4 <= n; i += 4)
+        store4d(f + i, anomaly_eccentric_to_true4d(load4d(e + i), load4d(E + i)));
+#endif
+
+    for(; i < n; ++i)
+        f[i] = anomaly_eccentric_to_true(e[i], E[i]);
+}
+
+void anomaly_true_to_eccentric_n(
+    const double *e, const double *f,
+    double *E,
+    size_t n) {
+    size_t i = 0;
+
+#ifndef TWOBODY_NO_SIMD
+    for(; i + 4 <= n; i += 4)
+        store4d(E + i, anomaly_true_to_eccentric4d(load4d(e + i), load4d(f + i)));
+#endif
+
+    for(; i < n; ++i)
+        E[i] = anomaly_true_to_eccentric(e[i], f[i]);
+}
+
+void anomaly_true_to_mean_n(
+    const double *e, const double *f,
+    double *M,
+    size_t n) {
+    size_t i = 0;
+
+#ifndef TWOBODY_NO_SIMD
+    for(; i + 4 <= n; i += 4) {
+        vec4d ee = load4d(e + i);
+        vec4d E = anomaly_true_to_eccentric4d(ee, load4d(f + i));
+        store4d(M + i, anomaly_eccentric_to_mean4d(ee, E));
+    }
+#endif
+
+    for(; i < n; ++i)
+        M[i] = anomaly_true_to_mean(e[i], f[i]);
+}
+
+void anomaly_mean_to_true_n(
+    const double *e, const double *M,
+    double *f,
+    size_t n) {
+    size_t i = 0;
+
+#ifndef TWOBODY_NO_SIMD
+    for(; i + 4 <= n; i += 4) {
+        double E[4];
+        anomaly_mean_to_eccentric_n(e + i, M + i, E, 4);
+
+        vec4d ee = load4d(e + i);
+        vec4d ff = anomaly_eccentric_to_true4d(ee, load4d(E));
+
+        // near-circular lanes use the series, same as anomaly_mean_to_true
+        vec4l series = ee < splat4d(ANOMALY_SERIES);
+        if(any4l(series))
+            for(int lane = 0; lane < 4; ++lane)
+                if(series[lane])
+                    ff[lane] = anomaly_true_series(e[i + lane], M[i + lane]);
+
+        store4d(f + i, ff);
+    }
+#endif
+
+    for(; i < n; ++i)
+        f[i] = anomaly_mean_to_true(e[i], M[i]);
+}
+
 double anomaly_dEdM(double e, double E) {
     if(conic_parabolic(e))
         return 2.0 / (E*E + 1.0);
@@ -24,6 +24,17 @@ int conic_closed(double e) {
     return !conic_parabolic(e) && e < 1.0;
 }
 
+enum conic_type conic_type(double e) {
+    if(conic_circular(e))
+        return CONIC_CIRCULAR;
+    else if(conic_parabolic(e))
+        return CONIC_PARABOLIC;
+    else if(conic_hyperbolic(e))
+        return CONIC_HYPERBOLIC;
+    else
+        return CONIC_ELLIPTIC;
+}
+
 double conic_semi_major_axis(double p, double e) {
     if(conic_parabolic(e))
         return INFINITY;
@@ -153,6 +153,27 @@ double eccentric_ydot(double mu, double p, double e, double E) {
         return sqrt(mu / (a*a*a)) * b*cos(E) / (1.0 - e*cos(E));
 }
 
+void eccentric_state_2d(
+    double mu, double p, double e,
+    double E,
+    double *x, double *y,
+    double *xdot, double *ydot) {
+    if(conic_parabolic(e)) {
+        eccentric_xy_parabolic(conic_periapsis(p, e), p, sqrt(mu / p),
+            E, x, y, xdot, ydot);
+    } else if(conic_hyperbolic(e)) {
+        double a = p / (1.0 - e*e);
+        double b = p / sqrt(e*e - 1.0);
+        eccentric_xy_hyperbolic(e, a, b, sqrt(mu / -(a*a*a)),
+            cosh(E), sinh(E), x, y, xdot, ydot);
+    } else {
+        double a = p / (1.0 - e*e);
+        double b = p / sqrt(1.0 - e*e);
+        eccentric_xy_elliptic(e, a, b, sqrt(mu / (a*a*a)),
+            cos(E), sin(E), x, y, xdot, ydot);
+    }
+}
+
 double eccentric_f(
     double mu, double p, double e,
     double r0,
@@ -0,0 +1,76 @@
+#include <twobody/conic.h>
+#include <twobody/anomaly.h>
+#include <twobody/kepler.h>
+#include <twobody/math_utils.h>
+
+#include <math.h>
+
+void kepler_ctx_init(struct kepler_ctx *ctx, double e) {
+    ctx->eccentricity = e;
+
+    if(!conic_elliptic(e)) // not used for open orbits
+        return;
+
+    const int segments = KEPLER_CTX_SEGMENTS;
+    double nodes[KEPLER_CTX_SEGMENTS+1];
+
+    for(int k = 0; k <= segments; ++k) {
+        // graded towards periapsis, uniform for circular orbits
+        nodes[k] = M_PI * pow(k / (double)segments, 1.0 + 3.0*e);
+        ctx->mean_anomaly[k] = anomaly_eccentric_to_mean(e, nodes[k]);
+    }
+
+    for(int k = 0; k < segments; ++k) {
+        // cubic Hermite interpolation of E(M), dE/dM at end points
+        double E0 = nodes[k], E1 = nodes[k+1];
+        double D0 = anomaly_dEdM(e, E0), D1 = anomaly_dEdM(e, E1);
+        double dM = ctx->mean_anomaly[k+1] - ctx->mean_anomaly[k];
+        double slope = (E1 - E0) / dM;
+
+        ctx->coeffs[k][0] = E0;
+        ctx->coeffs[k][1] = D0;
+        ctx->coeffs[k][2] = (3.0*slope - 2.0*D0 - D1) / dM;
+        ctx->coeffs[k][3] = (D0 + D1 - 2.0*slope) / (dM*dM);
+    }
+}
+
+double kepler_ctx_eccentricity(const struct kepler_ctx *ctx) {
+    return ctx->eccentricity;
+}
+
+double kepler_ctx_guess(const struct kepler_ctx *ctx, double M) {
+    double e = ctx->eccentricity;
+    if(!conic_elliptic(e))
+        return M;
+
+    // mean anomaly 0..pi, use symmetry for negative half
+    double MM = angle_clamp(M);
+    double Mperiod = M - MM;
+    double s = sign(MM);
+    double x = fabs(MM);
+
+    // branchless binary search for the segment
+    int k = 0;
+    for(int half = KEPLER_CTX_SEGMENTS/2; half > 0; half /= 2)
+        k += x >= ctx->mean_anomaly[k + half] ? half : 0;
+
+    const double *c = ctx->coeffs[k];
+    double t = x - ctx->mean_anomaly[k];
+    double E = c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+
+    return s * E + Mperiod;
+}
+
+double kepler_ctx_mean_to_eccentric(const struct kepler_ctx *ctx, double M) {
+    double e = ctx->eccentricity;
+    if(!conic_elliptic(e))
+        return anomaly_mean_to_eccentric(e, M);
+
+    // E - e*sin(E) cancels near periapsis, see anomaly_near_parabolic
+    if(anomaly_is_near_parabolic(e, M))
+        return anomaly_near_parabolic_iterate(e, M,
+            kepler_ctx_guess(ctx, M), KEPLER_CTX_STEPS);
+
+    return anomaly_eccentric_iterate(e, M,
+        kepler_ctx_guess(ctx, M), KEPLER_CTX_STEPS);
+}
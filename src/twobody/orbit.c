@@ -1,8 +1,10 @@
 #include <twobody/orbit.h>
 #include <twobody/conic.h>
 #include <twobody/orientation.h>
+#include <twobody/kepler.h>
 
 #include <twobody/math_utils.h>
+#include <twobody/simd4d_math.h>
 
 void orbit_from_elements(
     struct orbit *orbit,
@@ -17,6 +19,181 @@ void orbit_from_elements(
     orbit->major_axis = orientation_major_axis(i, an, arg);
     orbit->minor_axis = orientation_minor_axis(i, an, arg);
     orbit->normal_axis = orientation_normal_axis(i, an, arg);
+    orbit->kepler_ctx = 0;
+
+    orbit_prepare(orbit);
+}
+
+static void orbit_from_state4d(
+    struct orbit *orbits,
+    double mu,
+    const double *px, const double *py, const double *pz,
+    const double *vx, const double *vy, const double *vz,
+    const double *epoch,
+    size_t lanes) __attribute__((noinline));
+static void orbit_from_state4d(
+    struct orbit *orbits,
+    double mu,
+    const double *px, const double *py, const double *pz,
+    const double *vx, const double *vy, const double *vz,
+    const double *epoch,
+    size_t lanes) {
+    // lanes across orbits, branches become masks, no lane depends on
+    // another: the one body for orbit_from_state_n and orbit_from_state
+    const vec4d zero = splat4d(0.0), one = splat4d(1.0), eps = splat4d(DBL_EPSILON);
+    vec4d x = load4d(px), y = load4d(py), z = load4d(pz);
+    vec4d xdot = load4d(vx), ydot = load4d(vy), zdot = load4d(vz);
+    vec4d m = splat4d(mu);
+
+    vec4d r2 = x*x + y*y + z*z;
+    vec4d r = sqrt4d(r2);
+    vec4d v2 = xdot*xdot + ydot*ydot + zdot*zdot;
+    vec4d rv = x*xdot + y*ydot + z*zdot;
+
+    // specific orbital energy
+    vec4d visviva = v2/splat4d(2.0) - m/r;
+
+    // specific relative angular momentum
+    vec4d hx = y*zdot - z*ydot, hy = z*xdot - x*zdot, hz = x*ydot - y*xdot;
+    vec4d h2 = hx*hx + hy*hy + hz*hz;
+    vec4d h = sqrt4d(h2);
+    vec4l radial = h2 < eps;
+
+    // semi-latus rectum, eccentricity vector
+    vec4d p = h2 / m;
+    vec4d c1 = (v2 - m/r) / m, c2 = rv / m;
+    vec4d ex = c1*x - c2*xdot, ey = c1*y - c2*ydot, ez = c1*z - c2*zdot;
+    vec4d e2 = ex*ex + ey*ey + ez*ez;
+    vec4d e = sqrt4d(e2);
+    vec4l circular = e2 < eps;
+
+    // orbit normal vector and ascending node
+    vec4d nx = hx/h, ny = hy/h, nz = hz/h;
+    vec4d nodes2 = nx*nx + ny*ny;
+    vec4l equatorial = nodes2 < eps;
+
+    // major axis: x-axis, line of nodes or eccentricity vector
+    vec4d nodes = sqrt4d(nodes2);
+    vec4d mx = select4d(circular, -ny/nodes, ex/e);
+    vec4d my = select4d(circular, nx/nodes, ey/e);
+    vec4d mz = select4d(circular, zero, ez/e);
+    mx = select4d(circular & equatorial, one, mx);
+    my = select4d(circular & equatorial, zero, my);
+
+    // true anomaly, acos(c) = atan2(sqrt(1 - c^2), c)
+    vec4d c = (mx*x + my*y + mz*z) / r;
+    c = select4d(c < -one, -one, select4d(c > one, one, c));
+    vec4d f0 = atan2_4d(sqrt4d((one - c) * (one + c)), c);
+    f0 = select4d(mx*xdot + my*ydot + mz*zdot < zero, f0, -f0);
+
+    // mean anomaly and mean motion, see conic_mean_motion
+    double ee[4], ff[4], MM[4];
+    store4d(ee, e);
+    store4d(ff, f0);
+    anomaly_true_to_mean_n(ee, ff, MM, 4);
+
+    vec4d em1 = e - one;
+    vec4d a = p / (one - e2);
+    vec4d n = sqrt4d(m / abs4d(select4d(em1*em1 < eps, p*p*p, a*a*a)));
+
+    // periapsis time
+    vec4d t0 = load4d(epoch) - load4d(MM) / n;
+
+    // minor = normal x major
+    vec4d wx = ny*mz - nz*my, wy = nz*mx - nx*mz, wz = nx*my - ny*mx;
+
+    if(any4l(radial)) {
+        // major along the position, minor and normal from the closest axis
+        vec4l origin = r2 < eps;
+        vec4d rx = select4d(origin, one, x/r);
+        vec4d ry = select4d(origin, zero, y/r);
+        vec4d rz = select4d(origin, zero, z/r);
+
+        // up = (0, 1, 0) along the z-axis, (0, 0, 1) otherwise
+        vec4l polar = rx*rx + ry*ry < eps;
+        vec4d sx = select4d(polar, rz, -ry);   // up x major
+        vec4d sy = select4d(polar, zero, rx);
+        vec4d sz = select4d(polar, -rx, zero);
+        vec4d qx = ry*sz - rz*sy, qy = rz*sx - rx*sz, qz = rx*sy - ry*sx;
+
+        mx = select4d(radial, rx, mx); my = select4d(radial, ry, my);
+        mz = select4d(radial, rz, mz);
+        wx = select4d(radial, sx, wx); wy = select4d(radial, sy, wy);
+        wz = select4d(radial, sz, wz);
+        nx = select4d(radial, qx, nx); ny = select4d(radial, qy, ny);
+        nz = select4d(radial, qz, nz);
+        h = select4d(radial, zero, h);
+        t0 = select4d(radial, splat4d(NAN), t0);
+    }
+
+    // orbits of the first lanes, the others are padding
+    for(size_t lane = 0; lane < lanes; ++lane) {
+        struct orbit *orbit = orbits + lane;
+        orbit->gravity_parameter = mu;
+        orbit->orbital_energy = visviva[lane];
+        orbit->angular_momentum = h[lane];
+        orbit->periapsis_time = t0[lane];
+        orbit->major_axis = (vec4d){ mx[lane], my[lane], mz[lane], 0.0 };
+        orbit->minor_axis = (vec4d){ wx[lane], wy[lane], wz[lane], 0.0 };
+        orbit->normal_axis = (vec4d){ nx[lane], ny[lane], nz[lane], 0.0 };
+        orbit->kepler_ctx = 0;
+
+        orbit_prepare(orbit);
+    }
+}
+
+void orbit_from_state_n(
+    struct orbit *orbits,
+    double mu,
+    const double *x, const double *y, const double *z,
+    const double *vx, const double *vy, const double *vz,
+    const double *epoch,
+    size_t n) {
+    // a remainder below 4 is padded with copies of its last state, so that
+    // every orbit comes out of the same instructions
+    for(size_t i = 0; i < n; i += 4) {
+        const double *in[7] = {
+            x + i, y + i, z + i, vx + i, vy + i, vz + i, epoch + i };
+        double padded[7][4];
+        size_t m = n - i < 4 ? n - i : 4;
+
+        if(m < 4)
+            for(int k = 0; k < 7; ++k) {
+                for(size_t lane = 0; lane < 4; ++lane)
+                    padded[k][lane] = in[k][lane < m ? lane : m - 1];
+                in[k] = padded[k];
+            }
+
+        orbit_from_state4d(orbits + i, mu,
+            in[0], in[1], in[2], in[3], in[4], in[5], in[6], m);
+    }
+}
+
+void orbit_from_state_ptr(
+    struct orbit *orbit,
+    double mu,
+    const double *pos, const double *vel,
+    double epoch) {
+    orbit_from_state_n(orbit, mu,
+        pos + 0, pos + 1, pos + 2, vel + 0, vel + 1, vel + 2, &epoch, 1);
+}
+
+void orbit_prepare(struct orbit *orbit) {
+    double mu = orbit->gravity_parameter;
+    double h = orbit->angular_momentum;
+    double ee = orbit->orbital_energy;
+
+    double p = h*h / mu;
+    double e = sqrt(fmax(0.0, 1.0 + 2.0*ee*h*h / (mu*mu)));
+
+    orbit->semi_latus_rectum = p;
+    orbit->eccentricity = e;
+    orbit->semi_major_axis = conic_semi_major_axis(p, e);
+    orbit->semi_minor_axis = conic_semi_minor_axis(p, e);
+    orbit->periapsis = conic_periapsis(p, e);
+    orbit->mean_motion = conic_mean_motion(mu, p, e);
+    orbit->velocity_scale = sqrt(mu / p);
+    orbit->type = conic_type(e); // radial: e = 1 and NaN periapsis time
 }
 
 double orbit_gravity_parameter(const struct orbit *orbit) {
@@ -35,6 +212,14 @@ double orbit_periapsis_time(const struct orbit *orbit) {
     return orbit->periapsis_time;
 }
 
+void orbit_set_kepler_ctx(struct orbit *orbit, const struct kepler_ctx *ctx) {
+    orbit->kepler_ctx = ctx;
+}
+
+const struct kepler_ctx *orbit_kepler_ctx(const struct orbit *orbit) {
+    return orbit->kepler_ctx;
+}
+
 int orbit_zero(const struct orbit *orbit) {
     return !isfinite(orbit->orbital_energy) &&
         zero(orbit->angular_momentum);
@@ -59,45 +244,250 @@ int orbit_elliptic(const struct orbit *orbit) {
 }
 
 double orbit_semi_latus_rectum(const struct orbit *orbit) {
-    double mu = orbit->gravity_parameter;
-    double h = orbit->angular_momentum;
-    return h*h / mu;
+    return orbit->semi_latus_rectum;
 }
 
 double orbit_eccentricity(const struct orbit *orbit) {
-    double mu = orbit->gravity_parameter;
-    double h = orbit->angular_momentum;
-    double ee = orbit->orbital_energy;
-    return sqrt(fmax(0.0, 1.0 + 2.0*ee*h*h / (mu*mu)));
+    return orbit->eccentricity;
+}
+
+static void orbit_state_xy(
+    const struct orbit *orbit,
+    double *pos, double *vel,
+    double x, double y, double xdot, double ydot) {
+    *(vec4d*)pos = splat4d(x) * orbit->major_axis + splat4d(y) * orbit->minor_axis;
+    *(vec4d*)vel = splat4d(xdot) * orbit->major_axis + splat4d(ydot) * orbit->minor_axis;
+}
+
+static void orbit_state_time_circular(
+    const struct orbit *orbit,
+    double *pos, double *vel,
+    double M) {
+    // E = M + e sin(M) + O(e^2), e^2 < DBL_EPSILON, no Kepler solver
+    double e = orbit->eccentricity;
+    double cosM = cos(M), sinM = sin(M);
+    double cosE = cosM - e*sinM*sinM, sinE = sinM + e*sinM*cosM;
+
+    double x, y, xdot, ydot;
+    orbit_xy_elliptic(orbit, cosE, sinE, &x, &y, &xdot, &ydot);
+    orbit_state_xy(orbit, pos, vel, x, y, xdot, ydot);
+}
+
+static void orbit_state_time_elliptic(
+    const struct orbit *orbit,
+    double *pos, double *vel,
+    double M) {
+    double e = orbit->eccentricity;
+    double E;
+    if(!orbit->kepler_ctx)
+        E = anomaly_mean_to_eccentric(e, M);
+    else if(anomaly_is_near_parabolic(e, M))
+        E = anomaly_near_parabolic_iterate(e, M,
+            kepler_ctx_guess(orbit->kepler_ctx, M), KEPLER_CTX_STEPS);
+    else
+        E = anomaly_eccentric_iterate(e, M,
+            kepler_ctx_guess(orbit->kepler_ctx, M), KEPLER_CTX_STEPS);
+
+    double x, y, xdot, ydot;
+    orbit_xy_elliptic(orbit, cos(E), sin(E), &x, &y, &xdot, &ydot);
+    orbit_state_xy(orbit, pos, vel, x, y, xdot, ydot);
+}
+
+static void orbit_state_time_parabolic(
+    const struct orbit *orbit,
+    double *pos, double *vel,
+    double M) {
+    double E = anomaly_mean_to_eccentric(orbit->eccentricity, M);
+
+    double x, y, xdot, ydot;
+    orbit_xy_parabolic(orbit, E, &x, &y, &xdot, &ydot);
+    orbit_state_xy(orbit, pos, vel, x, y, xdot, ydot);
+}
+
+static void orbit_state_time_hyperbolic(
+    const struct orbit *orbit,
+    double *pos, double *vel,
+    double M) {
+    double E = anomaly_mean_to_eccentric(orbit->eccentricity, M);
+
+    double x, y, xdot, ydot;
+    orbit_xy_hyperbolic(orbit, E, &x, &y, &xdot, &ydot);
+    orbit_state_xy(orbit, pos, vel, x, y, xdot, ydot);
 }
 
 void orbit_state_true(
     const struct orbit *orbit,
     double *pos, double *vel,
     double f) {
-    *(vec4d*)pos = orbit_position_true(orbit, f);
-    *(vec4d*)vel = orbit_velocity_true(orbit, f);
+    double x, y, xdot, ydot;
+    orbit_xy_true(orbit, cos(f), sin(f), &x, &y, &xdot, &ydot);
+    orbit_state_xy(orbit, pos, vel, x, y, xdot, ydot);
+}
+
+void orbit_state_true_n(
+    const struct orbit *orbit,
+    double *pos, double *vel,
+    const double *f,
+    size_t n) {
+    size_t i = 0;
+
+    // 4 anomalies at a time, see orbit_xy_true
+    vec4d p = splat4d(orbit->semi_latus_rectum);
+    vec4d e = splat4d(orbit->eccentricity);
+    vec4d k = splat4d(orbit->velocity_scale);
+
+    for(; i + 4 <= n; i += 4) {
+        vec4d sin_f, cos_f;
+        sincos4d(load4d(f + i), &sin_f, &cos_f);
+
+        vec4d x, y, xdot, ydot;
+        true_state_xy4d(p, e, k, cos_f, sin_f, &x, &y, &xdot, &ydot);
+
+        for(int lane = 0; lane < 4; ++lane)
+            orbit_state_xy(orbit, pos + 4*(i + lane), vel + 4*(i + lane),
+                x[lane], y[lane], xdot[lane], ydot[lane]);
+    }
+
+    for(; i < n; ++i)
+        orbit_state_true(orbit, pos + 4*i, vel + 4*i, f[i]);
 }
 
 void orbit_state_eccentric(
     const struct orbit *orbit,
     double *pos, double *vel,
     double E) {
-    *(vec4d*)pos = orbit_position_eccentric(orbit, E);
-    *(vec4d*)vel = orbit_velocity_eccentric(orbit, E);
+    double x, y, xdot, ydot;
+    orbit_xy_eccentric(orbit, E, &x, &y, &xdot, &ydot);
+    orbit_state_xy(orbit, pos, vel, x, y, xdot, ydot);
 }
 
 void orbit_state_time(
     const struct orbit *orbit,
     double *pos, double *vel,
     double t) {
-    double mu = orbit_gravity_parameter(orbit);
-    double p = orbit_semi_latus_rectum(orbit);
-    double e = orbit_eccentricity(orbit);
+    double M = (t - orbit->periapsis_time) * orbit->mean_motion;
+
+    // classified once by orbit_prepare
+    switch(orbit->type) {
+    case CONIC_CIRCULAR:
+        orbit_state_time_circular(orbit, pos, vel, M);
+        break;
+    case CONIC_ELLIPTIC:
+        orbit_state_time_elliptic(orbit, pos, vel, M);
+        break;
+    case CONIC_PARABOLIC:
+        orbit_state_time_parabolic(orbit, pos, vel, M);
+        break;
+    case CONIC_HYPERBOLIC:
+        orbit_state_time_hyperbolic(orbit, pos, vel, M);
+        break;
+    }
+}
 
+void orbit_state_time_f(
+    const struct orbit *orbit,
+    float *pos, float *vel,
+    double t) {
+    double e = orbit->eccentricity;
+
+    // time and mean anomaly in double precision, float keeps only
+    // the fraction of a period
     double dt = t - orbit->periapsis_time;
-    double M = dt * conic_mean_motion(mu, p, e);
-    double E = anomaly_mean_to_eccentric(e, M);
+    double M = dt * orbit->mean_motion;
+    if(orbit->type == CONIC_CIRCULAR || orbit->type == CONIC_ELLIPTIC)
+        M = angle_clamp(M);
+
+    float E = anomaly_mean_to_eccentric_f(e, M);
+    float x, y, xdot, ydot;
+
+    if(orbit->type == CONIC_PARABOLIC) {
+        float p = orbit->semi_latus_rectum;
+        float k = orbit->velocity_scale * 2.0 / (E*E + 1.0f);
+        x = orbit->periapsis * (1.0f - E*E);
+        y = p * E;
+        xdot = -E * k;
+        ydot = k;
+    } else if(orbit->type == CONIC_HYPERBOLIC) {
+        float a = orbit->semi_major_axis;
+        float b = orbit->semi_minor_axis;
+        float coshE = coshf(E), sinhE = sinhf(E);
+
+        // cosh(E) - e and e*cosh(E) - 1 without cancellation near e = 1
+        float coshm1 = sinhE*sinhE / (coshE + 1.0f);
+        float em1 = e - 1.0;
+        float k = orbit->mean_motion / (em1 + e*coshm1);
+        x = a * (coshm1 - em1);
+        y = b * sinhE;
+        xdot = a * sinhE * k;
+        ydot = b * coshE * k;
+    } else {
+        float a = orbit->semi_major_axis;
+        float b = orbit->semi_minor_axis;
+        float cosE = cosf(E), sinE = sinf(E);
+
+        // cos(E) - e and 1 - e*cos(E) without cancellation near e = 1
+        float onemcos = cosE > 0.0f ? sinE*sinE / (1.0f + cosE) : 1.0f - cosE;
+        float oneme = 1.0 - e;
+        float k = orbit->mean_motion / (oneme + e*onemcos);
+        x = a * (oneme - onemcos);
+        y = b * sinE;
+        xdot = -a * sinE * k;
+        ydot = b * cosE * k;
+    }
+
+    for(int i = 0; i < 4; ++i) {
+        float major = orbit->major_axis[i], minor = orbit->minor_axis[i];
+        pos[i] = x * major + y * minor;
+        vel[i] = xdot * major + ydot * minor;
+    }
+}
+
+void orbit_cursor_init(
+    struct orbit_cursor *cursor,
+    const struct orbit *orbit,
+    double t) {
+    double e = orbit->eccentricity;
+    double n = orbit->mean_motion;
+
+    double M = (t - orbit->periapsis_time) * n;
+
+    cursor->orbit = orbit;
+    cursor->time = t;
+    cursor->mean_anomaly = M;
+    cursor->eccentric_anomaly = anomaly_mean_to_eccentric(e, M);
+}
+
+void orbit_cursor_advance(
+    struct orbit_cursor *cursor,
+    double *pos, double *vel,
+    double t) {
+    const struct orbit *orbit = cursor->orbit;
+    double e = orbit->eccentricity;
+
+    double M = (t - orbit->periapsis_time) * orbit->mean_motion;
+    double E = cursor->eccentric_anomaly;
+
+    if(orbit->type == CONIC_PARABOLIC) {
+        // closed form solution (Barker's equation)
+        E = anomaly_mean_to_eccentric(e, M);
+    } else {
+        // first order extrapolation from previous time
+        double dM = M - cursor->mean_anomaly;
+        double dE = anomaly_dEdM(e, E) * dM;
+
+        if(fabs(dE) >= 1.0) // large steps: start from scratch
+            E = anomaly_mean_to_eccentric(e, M);
+        else if(anomaly_is_near_parabolic(e, M))
+            E = anomaly_near_parabolic_iterate(e, M, E + dE, 0);
+        else if(orbit->type == CONIC_HYPERBOLIC)
+            E = anomaly_hyperbolic_iterate(e, M, E + dE, 0);
+        else
+            E = anomaly_eccentric_iterate(e, M, E + dE, 0);
+    }
+
+    cursor->time = t;
+    cursor->mean_anomaly = M;
+    cursor->eccentric_anomaly = E;
 
     orbit_state_eccentric(orbit, pos, vel, E);
 }
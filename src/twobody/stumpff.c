@@ -4,6 +4,8 @@
 #include <math.h>
 #include <float.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
 
 double stumpff_c0(double z) {
     double sqrtz = sqrt(fabs(z));
@@ -144,16 +146,64 @@ double stumpff_series_dcdz(int k, double z) {
     return sum;
 }
 
-void stumpff_fast(double z, double *cs) {
-    double z_min = 0.1;
-    int n = 0;
+// piecewise polynomials for c2 .. c5, |z| < 64 (stumpff_table_gen.c)
+#include "stumpff_table.h"
+
+static int stumpff_table_index(double z) {
+    // |z| < STUMPFF_TABLE_ZMAX, clamp in double: converting NaN or an out of
+    // range value to int is undefined, NaN goes to the first interval
+    double x = (z + STUMPFF_TABLE_ZMAX) * (1.0 / STUMPFF_TABLE_WIDTH);
+    if(!(x >= 0.0))
+        x = 0.0;
+    if(x > STUMPFF_TABLE_INTERVALS - 1)
+        x = STUMPFF_TABLE_INTERVALS - 1;
+    return (int)x;
+}
+
+static inline void stumpff_table_eval(double z, int num, double *c)
+    __attribute__((always_inline));
+static inline void stumpff_table_eval(double z, int num, double *c) {
+    // c[k] = c_k+2(z), k < num
+    // center in integer arithmetic, -ffast-math would otherwise reassociate
+    // to (z + ZMAX) - ... and round z to the ulp of ZMAX
+    int i = stumpff_table_index(z);
+    double t = z - (2*i + 1 - STUMPFF_TABLE_INTERVALS) * (0.5 * STUMPFF_TABLE_WIDTH);
+
+    for(int k = 0; k < num; ++k) {
+        const double *coeffs = stumpff_table[i][k];
+
+        double p = coeffs[STUMPFF_TABLE_DEGREE];
+        for(int j = STUMPFF_TABLE_DEGREE - 1; j >= 0; --j)
+            p = p*t + coeffs[j];
+        c[k] = p;
+    }
+}
 
-    for(n = 0; z*z >= z_min; ++n) // TODO: use pow and trunc
-        z = z / 4;
+static long stumpff_reductions(double z) {
+    // divide z by 4 n times for |z| < 64, n directly from the exponent:
+    // (ilogb(z) - 4) / 2 without the libm calls
+    long bits;
+    memcpy(&bits, &z, sizeof(bits));
+    long n = ((((bits >> 52) & 0x7ff) - 1023) - 4) >> 1;
+    return n < 0 ? 0 : (n > 511 ? 511 : n); // 4^-n normal, z not infinite
+}
 
-    double c2 = stumpff_series(2, z);
-    double c3 = stumpff_series(3, z);
+static double stumpff_scale(long n) {
+    // 4^-n, n <= 511
+    long bits = (1023 - 2*n) << 52;
+    double x;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
 
+void stumpff_fast(double z, double *cs) {
+    long n = stumpff_reductions(z);
+    z = z * stumpff_scale(n);
+
+    double c[2];
+    stumpff_table_eval(z, 2, c);
+
+    double c2 = c[0], c3 = c[1];
     double c1 = 1.0 - z*c3;
     double c0 = 1.0 - z*c2;
 
@@ -166,3 +216,55 @@ void stumpff_fast(double z, double *cs) {
 
     cs[0] = c0; cs[1] = c1; cs[2] = c2; cs[3] = c3;
 }
+
+void stumpff_fast_with_derivatives(double z, double *cs, double *dcs) {
+    // values as in stumpff_fast, derivatives from c0 .. c5 with
+    //   2 dc_k/dz = k*c_k+2 - c_k+1
+    long n = stumpff_reductions(z);
+    double zz = z * stumpff_scale(n);
+
+    double c[4];
+    stumpff_table_eval(zz, n ? 2 : 4, c);
+
+    double c2 = c[0], c3 = c[1];
+    double c1 = 1.0 - zz*c3;
+    double c0 = 1.0 - zz*c2;
+
+    for(long i = 0; i < n; ++i) {
+        c3 = (c2 + c0*c3) / 4.0;
+        c2 = c1*c1 / 2.0;
+        c1 = c0*c1;
+        c0 = 2.0 * c0*c0 - 1.0;
+    }
+
+    // reduced: c4 and c5 from the table
+    // doubled: |z| >= 64, c_k+2 = (1/k! - c_k) / z does not cancel
+    double c4 = n ? (1.0/2.0 - c2) / z : c[2];
+    double c5 = n ? (1.0/6.0 - c3) / z : c[3];
+
+    cs[0] = c0; cs[1] = c1; cs[2] = c2; cs[3] = c3;
+
+    dcs[0] = -0.5 * c1;
+    dcs[1] = 0.5 * (c3 - c2);
+    dcs[2] = 0.5 * (2.0*c4 - c3);
+    dcs[3] = 0.5 * (3.0*c5 - c4);
+}
+
+void stumpff_fast_n(const double *z, double *cs, size_t n) {
+    // cs[4*i + k] = c_k(z[i])
+    size_t i = 0;
+
+#ifndef TWOBODY_NO_SIMD
+    for(; i + 4 <= n; i += 4) {
+        vec4d c[4];
+        stumpff_fast4d(load4d(z + i), c);
+
+        for(int lane = 0; lane < 4; ++lane)
+            for(int k = 0; k < 4; ++k)
+                cs[4*(i + lane) + k] = c[k][lane];
+    }
+#endif
+
+    for(; i < n; ++i)
+        stumpff_fast(z[i], cs + 4*i);
+}
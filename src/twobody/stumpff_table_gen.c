@@ -0,0 +1,101 @@
+// generates stumpff_table.h: piecewise polynomials for c2(z) .. c5(z)
+//
+// c_k(z) on each interval is interpolated at Chebyshev nodes (long double
+// series) and written in the power basis of t = z - center, evaluation is
+// a single Horner pass. Error is about 1 ulp for |z| <= ZMAX, relative to
+// the interval maximum near the zeros of c2 at z = (2 pi k)^2.
+
+#include <math.h>
+#include <stdio.h>
+
+#define ZMAX 64.0
+#define WIDTH 2.0
+#define INTERVALS ((int)(2.0 * ZMAX / WIDTH))
+#define DEGREE 8
+#define FUNCTIONS 4 // c2, c3, c4, c5
+
+static long double stumpff_series_ld(int k, long double z) {
+    // c_k(z) = sum (-z)^i / (k + 2i)!
+    long double c = 1.0L;
+    for(int i = 2; i <= k; ++i)
+        c = c / i;
+
+    long double sum = c;
+    for(int i = 1; i < 60; ++i) {
+        c = c * -z / ((long double)(k + 2*i) * (k + 2*i - 1));
+        sum += c;
+    }
+
+    return sum;
+}
+
+static void stumpff_table_fit(int k, long double center, double *coeffs) {
+    const int N = DEGREE + 1;
+    const long double pi = 3.141592653589793238462643383279502884L;
+    long double h = WIDTH / 2.0;
+
+    // Chebyshev coefficients on [center - h, center + h]
+    long double cheb[DEGREE + 1] = { 0.0L };
+    for(int j = 0; j < N; ++j) {
+        long double x = cosl(pi * (j + 0.5L) / N);
+        long double y = stumpff_series_ld(k, center + h*x);
+
+        for(int m = 0; m < N; ++m)
+            cheb[m] += y * cosl(pi * m * (j + 0.5L) / N) * 2.0L / N;
+    }
+    cheb[0] /= 2.0L;
+
+    // power basis in x = t/h, T_m+1 = 2x T_m - T_m-1
+    long double poly[DEGREE + 1] = { 0.0L };
+    long double prev[DEGREE + 1] = { 1.0L }, cur[DEGREE + 1] = { 0.0L, 1.0L };
+    poly[0] = cheb[0];
+    for(int m = 1; m < N; ++m) {
+        for(int i = 0; i < N; ++i)
+            poly[i] += cheb[m] * cur[i];
+
+        long double next[DEGREE + 1];
+        for(int i = 0; i < N; ++i)
+            next[i] = (i > 0 ? 2.0L * cur[i-1] : 0.0L) - prev[i];
+        for(int i = 0; i < N; ++i) {
+            prev[i] = cur[i];
+            cur[i] = next[i];
+        }
+    }
+
+    for(int i = 0; i < N; ++i)
+        coeffs[i] = (double)(poly[i] / powl(h, i));
+}
+
+int main() {
+    printf("// generated by stumpff_table_gen, do not edit\n");
+    printf("#define STUMPFF_TABLE_ZMAX %.1f\n", ZMAX);
+    printf("#define STUMPFF_TABLE_WIDTH %.1f\n", WIDTH);
+    printf("#define STUMPFF_TABLE_INTERVALS %d\n", INTERVALS);
+    printf("#define STUMPFF_TABLE_DEGREE %d\n", DEGREE);
+    printf("#define STUMPFF_TABLE_FUNCTIONS %d\n\n", FUNCTIONS);
+
+    printf("// c2 .. c5, coefficients of (z - center)^i\n");
+    printf("static const double stumpff_table[STUMPFF_TABLE_INTERVALS]"
+        "[STUMPFF_TABLE_FUNCTIONS][STUMPFF_TABLE_DEGREE + 1] = {\n");
+
+    for(int interval = 0; interval < INTERVALS; ++interval) {
+        long double center = -ZMAX + WIDTH * (interval + 0.5L);
+        printf("    { // z = %g\n", (double)center);
+
+        for(int k = 2; k < 2 + FUNCTIONS; ++k) {
+            double coeffs[DEGREE + 1];
+            stumpff_table_fit(k, center, coeffs);
+
+            printf("        { ");
+            for(int i = 0; i <= DEGREE; ++i)
+                printf("%s%.17g", i == 0 ? "" : (i % 3 ? ", " : ",\n          "),
+                    coeffs[i]);
+            printf(" },\n");
+        }
+
+        printf("    },\n");
+    }
+
+    printf("};\n");
+    return 0;
+}
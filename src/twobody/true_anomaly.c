@@ -56,6 +56,14 @@ double true_ydot(double mu, double p, double e, double f) {
     return sqrt(mu / p) * (e + cos(f));
 }
 
+void true_state_2d(
+    double mu, double p, double e,
+    double f,
+    double *x, double *y,
+    double *xdot, double *ydot) {
+    true_state_xy(p, e, sqrt(mu / p), cos(f), sin(f), x, y, xdot, ydot);
+}
+
 double true_f(double mu, double p, double r0, double r, double df) {
     (void)mu; (void)r0;
     return 1.0 - (r/p) * (1.0 - cos(df));
@@ -1,3 +1,179 @@
 #include <twobody/twobody.h>
 
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
 const char *twobody_version() { return "0.0.1"; }
+
+static double twobody_clock() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+static uint64_t twobody_hash(uint64_t hash, const void *data, size_t size) {
+    // FNV-1a
+    const unsigned char *bytes = data;
+    for(size_t i = 0; i < size; ++i)
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    return hash;
+}
+
+static uint64_t twobody_hash_cpu(uint64_t hash) {
+    // brand string, signature and feature flags, tuning is host specific
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int regs[4] = { 0 };
+    for(unsigned int leaf = 0x80000002; leaf <= 0x80000004; ++leaf) {
+        if(__get_cpuid(leaf, &regs[0], &regs[1], &regs[2], &regs[3]))
+            hash = twobody_hash(hash, regs, sizeof(regs));
+    }
+    if(__get_cpuid(1, &regs[0], &regs[1], &regs[2], &regs[3]))
+        hash = twobody_hash(hash, regs, sizeof(regs));
+    if(__get_cpuid_count(7, 0, &regs[0], &regs[1], &regs[2], &regs[3]))
+        hash = twobody_hash(hash, regs, sizeof(regs));
+#endif
+    return hash;
+}
+
+static int twobody_autotune_read(
+    const char *cache_path, uint64_t hash,
+    enum anomaly_solver *solver) {
+    FILE *file = cache_path ? fopen(cache_path, "r") : 0;
+    if(!file)
+        return 0;
+
+    char version[32];
+    unsigned long long file_hash;
+    int file_solver;
+    int ok = fscanf(file, "twobody %31s %llx %d",
+            version, &file_hash, &file_solver) == 3 &&
+        strcmp(version, twobody_version()) == 0 &&
+        file_hash == hash &&
+        file_solver >= ANOMALY_SOLVER_LAGUERRE_CONWAY &&
+        file_solver <= ANOMALY_SOLVER_FIXED;
+    fclose(file);
+
+    if(ok)
+        *solver = (enum anomaly_solver)file_solver;
+    return ok;
+}
+
+static void twobody_autotune_write(
+    const char *cache_path, uint64_t hash,
+    enum anomaly_solver solver) {
+    FILE *file = cache_path ? fopen(cache_path, "w") : 0;
+    if(!file)
+        return; // no cache, tune again next time
+
+    fprintf(file, "twobody %s %llx %d\n",
+        twobody_version(), (unsigned long long)hash, (int)solver);
+    fclose(file);
+}
+
+static double twobody_autotune_time(
+    const double *e, const double *M,
+    double *E, double *E_n,
+    size_t n) {
+    // best of a few runs, scalar solver into E and batch solver into E_n
+    double best = INFINITY;
+    for(int r = 0; r < 5; ++r) {
+        double t0 = twobody_clock();
+        for(size_t i = 0; i < n; ++i)
+            E[i] = anomaly_mean_to_eccentric(e[i], M[i]);
+        anomaly_mean_to_eccentric_n(e, M, E_n, n);
+        double t1 = twobody_clock();
+
+        best = fmin(best, t1 - t0);
+    }
+
+    return best;
+}
+
+enum anomaly_solver twobody_autotune(
+    const double *e, const double *M, size_t n,
+    const char *cache_path) {
+    // same result as the default solver to this precision (relative to |E| > 1)
+    const double tolerance = 1.0e-12;
+
+    enum anomaly_solver solver = anomaly_get_solver();
+
+    double *samples = 0;
+    if(!e || !M || n == 0) {
+        // elliptic e 0..0.99 and M -pi..pi, there is no separate hyperbolic
+        // strategy, hyperbolic orbits follow the same choice
+        n = 4096;
+        samples = malloc(2 * n * sizeof(*samples));
+        if(!samples)
+            return solver;
+
+        double *e_default = samples, *M_default = samples + n;
+        for(size_t i = 0; i < n; ++i) {
+            double u = (i % 97) / 97.0, v = (i % 101) / 101.0;
+            e_default[i] = 0.99 * u;
+            M_default[i] = M_PI * (-1.0 + 2.0 * v);
+        }
+
+        e = e_default;
+        M = M_default;
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = twobody_hash_cpu(hash);
+    hash = twobody_hash(hash, &n, sizeof(n));
+    hash = twobody_hash(hash, e, n * sizeof(*e));
+    hash = twobody_hash(hash, M, n * sizeof(*M));
+
+    double *E = 0;
+    if(twobody_autotune_read(cache_path, hash, &solver) ||
+        !(E = malloc(3 * n * sizeof(*E)))) {
+        free(samples);
+        anomaly_set_solver(solver);
+        return solver;
+    }
+    double *E_n = E + n, *Eref = E + 2*n;
+
+    const enum anomaly_solver solvers[] = {
+        ANOMALY_SOLVER_LAGUERRE_CONWAY,
+        ANOMALY_SOLVER_MARKLEY,
+        ANOMALY_SOLVER_FIXED,
+    };
+    const int num_solvers = sizeof(solvers)/sizeof(*solvers);
+
+    anomaly_set_solver(ANOMALY_SOLVER_LAGUERRE_CONWAY);
+    for(size_t i = 0; i < n; ++i)
+        Eref[i] = anomaly_mean_to_eccentric(e[i], M[i]);
+
+    enum anomaly_solver best = ANOMALY_SOLVER_LAGUERRE_CONWAY;
+    double best_time = INFINITY;
+    for(int s = 0; s < num_solvers; ++s) {
+        anomaly_set_solver(solvers[s]);
+        double time = twobody_autotune_time(e, M, E, E_n, n);
+
+        // both the scalar and the batch solver
+        int accurate = 1;
+        for(size_t i = 0; i < n && accurate; ++i)
+            accurate =
+                fabs(E[i] - Eref[i]) <= tolerance * fmax(1.0, fabs(Eref[i])) &&
+                fabs(E_n[i] - Eref[i]) <= tolerance * fmax(1.0, fabs(Eref[i]));
+
+        if(accurate && time < best_time) {
+            best = solvers[s];
+            best_time = time;
+        }
+    }
+
+    free(E);
+    free(samples);
+
+    anomaly_set_solver(best);
+    twobody_autotune_write(cache_path, hash, best);
+    return best;
+}
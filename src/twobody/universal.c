@@ -1,9 +1,55 @@
 #include <twobody/conic.h>
+#include <twobody/anomaly.h>
 #include <twobody/stumpff.h>
 #include <twobody/universal.h>
 #include <twobody/math_utils.h>
 
+#ifndef TWOBODY_NO_SIMD
+#include <twobody/simd4d.h>
+#include <twobody/simd4d_math.h>
+#endif
+
 #include <math.h>
+#include <float.h>
+#include <stddef.h>
+
+#ifndef TWOBODY_NO_SIMD
+static inline void universal_fg4d(
+    vec4d sqrt_mu,
+    vec4d r0, vec4d sigma0,
+    vec4d alpha,
+    const vec4d *u,
+    vec4d *out) __attribute__((always_inline));
+static inline void universal_fg4d(
+    vec4d sqrt_mu,
+    vec4d r0, vec4d sigma0,
+    vec4d alpha,
+    const vec4d *u,
+    vec4d *out) {
+    // see universal_fg_u
+    vec4d s_c1 = u[1], ss_c2 = u[2];
+    vec4d r = r0 * u[0] + sigma0 * s_c1 + ss_c2;
+
+    out[0] = r;
+    out[1] = sigma0 * u[0] + (splat4d(1.0) - alpha * r0) * s_c1;
+    out[2] = splat4d(1.0) - ss_c2 / r0;
+    out[3] = (r0 * s_c1 + sigma0 * ss_c2) / sqrt_mu;
+    out[4] = -sqrt_mu / (r0*r) * s_c1;
+    out[5] = splat4d(1.0) - ss_c2 / r;
+}
+#endif
+
+static unsigned long *universal_histogram = 0;
+
+void universal_set_histogram(unsigned long *histogram) {
+    universal_histogram = histogram;
+}
+
+static void universal_count_steps(int steps) {
+    if(steps > UNIVERSAL_MAX_STEPS)
+        steps = UNIVERSAL_MAX_STEPS;
+    universal_histogram[steps] += 1;
+}
 
 double universal_alpha(double mu, double r, double v2) {
     return 2.0/r - v2/mu;
@@ -140,36 +186,180 @@ double universal_gdot(
     return 1.0 - 1/r * s*s * cs[2];
 }
 
+static void universal_fg_u(
+    double mu,
+    double r0, double sigma0,
+    double alpha,
+    const double *u,
+    double *out) {
+    // u[k] = s^k c_k(alpha s^2), k = 0..2
+    double sqrt_mu = sqrt(mu);
+    double s_c1 = u[1], ss_c2 = u[2];
+    double r = r0 * u[0] + sigma0 * s_c1 + ss_c2;
+
+    out[0] = r;
+    out[1] = sigma0 * u[0] + (1.0 - alpha * r0) * s_c1;
+    out[2] = 1.0 - ss_c2 / r0;
+    out[3] = (r0 * s_c1 + sigma0 * ss_c2) / sqrt_mu;
+    out[4] = -sqrt_mu / (r0*r) * s_c1;
+    out[5] = 1.0 - ss_c2 / r;
+}
+
+void universal_fg(
+    double mu,
+    double r0, double sigma0,
+    double alpha,
+    double s, const double *cs,
+    double *out) {
+    double u[3] = { cs[0], s * cs[1], s*s * cs[2] };
+    universal_fg_u(mu, r0, sigma0, alpha, u, out);
+}
+
+void universal_fg_n(
+    double mu,
+    const double *r0, const double *sigma0,
+    const double *alpha,
+    const double *s,
+    double *out,
+    size_t n) {
+    // out[6*i + k], the Stumpff values of alpha*s^2 are computed here
+    size_t i = 0;
+
+#ifndef TWOBODY_NO_SIMD
+    vec4d sqrt_mu = splat4d(sqrt(mu));
+
+    for(; i + 4 <= n; i += 4) {
+        vec4d ss = load4d(s + i), aa = load4d(alpha + i);
+        vec4d cs[4], fg[6];
+        stumpff_fast4d(aa * ss*ss, cs);
+        vec4d u[3] = { cs[0], ss * cs[1], ss*ss * cs[2] };
+        universal_fg4d(sqrt_mu, load4d(r0 + i), load4d(sigma0 + i), aa, u, fg);
+
+        for(int lane = 0; lane < 4; ++lane)
+            for(int k = 0; k < 6; ++k)
+                out[6*(i + lane) + k] = fg[k][lane];
+    }
+#endif
+
+    for(; i < n; ++i) {
+        double cs[4];
+        stumpff_fast(alpha[i] * s[i]*s[i], cs);
+        universal_fg(mu, r0[i], sigma0[i], alpha[i], s[i], cs, out + 6*i);
+    }
+}
+
+static int universal_guess_s_parabolic(
+    double mu,
+    double alpha,
+    double r0, double sigma0,
+    double time,
+    double *s) {
+    // time of flight with c1 = 1, c2 = 1/2, c3 = 1/6 (Barker's equation):
+    //   s^3/6 + sigma0*s^2/2 + r0*s = sqrt(mu)*t
+    // substitute s = u - sigma0: u^3 + a*u = b
+    double a = 6.0*r0 - 3.0*sigma0*sigma0;
+    double b = 6.0*sqrt(mu)*time + 6.0*r0*sigma0 - 2.0*sigma0*sigma0*sigma0;
+
+    if(universal_parabolic(alpha)) // sigma0^2 <= 2*r0, equal when radial
+        a = fmax(a, 0.0);
+    else if(a < 0.0) // not monotonic, orbit too far from parabolic
+        return 0;
+
+    double A = cbrt(fabs(b)/2.0 + sqrt(b*b/4.0 + a*a*a/27.0));
+    double B = a / (3.0*A);
+    double u = A > 0.0 ? // a = b = 0: u = 0
+        sign(b) * fabs(b) / (A*A + A*B + B*B) : // A - B without cancellation
+        0.0;
+
+    *s = u - sigma0;
+    return 1;
+}
+
 double universal_guess_s(
     double mu,
     double alpha,
     double r0, double sigma0,
     double time) {
-    if(universal_parabolic(alpha))
-        return sqrt(mu) / r0  * time; // XXX: this sucks
-    else if(universal_hyperbolic(alpha))
-        return zero(time) ? 0.0 :
-            sign(time) * sqrt(1.0/-alpha) *
-            log(-2.0 * alpha * mu * time /
-                (sqrt(mu)*sigma0 +
-                     sign(time) * sqrt(mu/-alpha) * (1 - alpha*r0)));
-    else
-        return alpha*sqrt(mu) * time;
+    double s;
+
+    // parabolic or near-parabolic arc: c3(alpha*s^2) is close to 1/6
+    if(universal_guess_s_parabolic(mu, alpha, r0, sigma0, time, &s) &&
+        (universal_parabolic(alpha) || fabs(alpha) * s*s < 1.0))
+        return s;
+
+    // otherwise solve Kepler's equation from the anomaly at time 0:
+    //   e*cos(E0) = 1 - alpha*r0, e*sin(E0) = sqrt(alpha)*sigma0
+    // s = (E - E0) / sqrt(alpha), cosh and sinh for hyperbolic orbits
+    double k = sqrt(fabs(alpha));
+    double ecos0 = 1.0 - alpha*r0, esin0 = k*sigma0;
+    double dM = sqrt(mu) * k*k*k * time; // mean motion * time
+
+    if(universal_hyperbolic(alpha)) {
+        // short arc away from periapsis, second order in dH:
+        //   e*sinh(H0)*dH^2/2 + (e*cosh(H0) - 1)*dH = dM
+        // while the third order term e*cosh(H0)*dH^3/6 is small
+        double b = -alpha*r0; // e*cosh(H0) - 1
+        if(fabs(dM) < 1.0 && esin0*dM >= 0.0 && dM*dM*ecos0 < b*b*b)
+            return 2.0*dM / (b + sqrt(b*b + 2.0*esin0*dM)) / k;
+
+        if(fabs(dM) >= 1.0) {
+            // asymptotic, e*sinh(H) grows as exp(|H|)/2
+            s = sign(time) * sqrt(1.0/-alpha) *
+                log(-2.0 * alpha * mu * time /
+                    (sqrt(mu)*sigma0 +
+                        sign(time) * sqrt(mu/-alpha) * (1 - alpha*r0)));
+            if(s * time > 0.0) // log below 0 close to periapsis
+                return s;
+        }
+
+        // towards or across periapsis, hyperbolic anomaly guess
+        double e = sqrt(fmax(ecos0*ecos0 - esin0*esin0, 1.0));
+        double H0 = asinh(esin0 / e);
+        return (anomaly_hyperbolic_guess(e, esin0 - H0 + dM) - H0) / k;
+    }
+
+    // one Newton step of Kepler's equation from E0 + dM, relative to E0 so
+    // that whole revolutions need no reduction, e*sin(E) - e*sin(E0) bounds
+    // the step
+    double sin_dM = sin(dM), cos_dM = cos(dM);
+    double esin = esin0*cos_dM + ecos0*sin_dM;
+    double ecos = ecos0*cos_dM - esin0*sin_dM;
+    double e = sqrt(ecos0*ecos0 + esin0*esin0);
+    double dE = (esin - esin0) / (1.0 - ecos);
+    dE = fmin(fmax(dE, -e - esin0), e - esin0);
+    return (dM + dE) / k;
 }
 
-double universal_iterate_s(
+static inline void universal_u_step(
+    double alpha, double ds,
+    double *u) __attribute__((always_inline));
+static inline void universal_u_step(
+    double alpha, double ds,
+    double *u) {
+    // u[k] = s^k c_k(alpha s^2) at s + ds from s, Taylor series with
+    // u0' = -alpha u1, u1' = u0, u2' = u1, exact to ds^3
+    double h = 0.5*ds*ds;
+    double u0 = u[0] - alpha * (ds*u[1] + h*u[0]);
+    double u1 = u[1] + ds*u[0] - alpha * h*u[1];
+    double u2 = u[2] + ds*u[1] + h*u[0];
+    u[0] = u0;
+    u[1] = u1;
+    u[2] = u2;
+}
+
+static double universal_solve_s(
     double mu,
     double alpha,
     double r0, double sigma0,
     double s0, double time,
-    int max_steps) {
-    if(max_steps <= 0)
-        max_steps = 20;
-
-    double threshold = DBL_EPSILON;
+    int max_steps, int fixed, double threshold,
+    double *u) {
+    // u (optional): u[k] = s^k c_k(alpha s^2), k = 0..2, at the result,
+    // updated from the last step instead of another Stumpff evaluation
     double s = s0;
+    int step = 0, converged = 0;
 
-    for(int step = 0; step < max_steps; ++step) {
+    while(step < max_steps) {
         double z = alpha * s*s;
         double cs[4];
         stumpff_fast(z, cs);
@@ -185,11 +375,335 @@ double universal_iterate_s(
         double N = 5.0; // laguerre-conway magic constant
         double ds = -N * f0 /
             (f1 + sign(f1) * sqrt(fabs(square(N-1.0) * f1*f1 - N*(N-1.0) * f0*f2)));
+        if(u) {
+            u[0] = cs[0];
+            u[1] = s * cs[1];
+            u[2] = s*s * cs[2];
+            universal_u_step(alpha, ds, u);
+        }
+
         s = s + ds;
+        step += 1;
 
-        if(ds*ds < threshold)
+        if(!fixed && ds*ds < threshold) {
+            converged = 1;
             break;
+        }
+    }
+
+    if(universal_histogram && !fixed)
+        universal_count_steps(step);
+
+    if(u && !converged) { // ds^3 may be large
+        double cs[4];
+        stumpff_fast(alpha * s*s, cs);
+        u[0] = cs[0];
+        u[1] = s * cs[1];
+        u[2] = s*s * cs[2];
     }
 
     return s;
 }
+
+double universal_iterate_s(
+    double mu,
+    double alpha,
+    double r0, double sigma0,
+    double s0, double time,
+    int max_steps) {
+    return universal_iterate_s_tol(
+        mu, alpha, r0, sigma0, s0, time, max_steps, DBL_EPSILON);
+}
+
+double universal_iterate_s_tol(
+    double mu,
+    double alpha,
+    double r0, double sigma0,
+    double s0, double time,
+    int max_steps, double tol) {
+    if(max_steps <= 0)
+        max_steps = UNIVERSAL_MAX_STEPS;
+    return universal_solve_s(
+        mu, alpha, r0, sigma0, s0, time, max_steps, 0, tol, 0);
+}
+
+double universal_iterate_s_fixed(
+    double mu,
+    double alpha,
+    double r0, double sigma0,
+    double s0, double time,
+    int steps) {
+    // no early exit, run time does not depend on convergence
+    return universal_solve_s(mu, alpha, r0, sigma0, s0, time, steps, 1, 0.0, 0);
+}
+
+void universal_propagate(
+    double mu,
+    const double *pos, const double *vel,
+    double dt,
+    double *pos_out, double *vel_out) {
+    double r0 = sqrt(pos[0]*pos[0] + pos[1]*pos[1] + pos[2]*pos[2]);
+    double v2 = vel[0]*vel[0] + vel[1]*vel[1] + vel[2]*vel[2];
+    double sigma0 = (pos[0]*vel[0] + pos[1]*vel[1] + pos[2]*vel[2]) / sqrt(mu);
+    double alpha = universal_alpha(mu, r0, v2);
+
+    // the Stumpff values of the last step carried to the solution, for the
+    // radius and all four coefficients
+    double u[3], fg[6];
+    double s0 = universal_guess_s(mu, alpha, r0, sigma0, dt);
+    universal_solve_s(mu, alpha, r0, sigma0, s0, dt,
+        UNIVERSAL_MAX_STEPS, 0, DBL_EPSILON, u);
+    universal_fg_u(mu, r0, sigma0, alpha, u, fg);
+
+    // pos_out and vel_out may alias pos and vel
+    double x[3], v[3];
+    for(int i = 0; i < 3; ++i) {
+        x[i] = fg[2] * pos[i] + fg[3] * vel[i];
+        v[i] = fg[4] * pos[i] + fg[5] * vel[i];
+    }
+
+    for(int i = 0; i < 3; ++i) {
+        pos_out[i] = x[i];
+        vel_out[i] = v[i];
+    }
+}
+
+#ifndef TWOBODY_NO_SIMD
+static vec4d universal_guess_s4d(
+    double mu,
+    vec4d alpha,
+    vec4d r0, vec4d sigma0,
+    vec4d time) {
+    // see universal_guess_s, the parabolic starter for all lanes, the others
+    // and a select, lanes close to periapsis of a hyperbola use the scalar
+    // starter
+    vec4d one = splat4d(1.0), zero = splat4d(0.0);
+    vec4d sqrt_mu = splat4d(sqrt(mu));
+
+    vec4d a = splat4d(6.0)*r0 - splat4d(3.0)*sigma0*sigma0;
+    vec4d b = splat4d(6.0)*sqrt_mu*time + splat4d(6.0)*r0*sigma0 -
+        splat4d(2.0)*sigma0*sigma0*sigma0;
+    // parabolic alpha: a >= 0 up to rounding, otherwise not monotonic
+    vec4l parabolic_alpha = abs4d(alpha) < splat4d(DBL_EPSILON);
+    a = select4d(parabolic_alpha & (a < zero), zero, a);
+    vec4l monotonic = a >= zero;
+    a = select4d(monotonic, a, zero);
+    vec4d w = abs4d(b)*splat4d(0.5) + sqrt4d(b*b*splat4d(0.25) + a*a*a*splat4d(1.0/27.0));
+    // cbrt as exp(log(w)/3), cbrt4d is lane by lane, accurate enough to start
+    vec4l positive = w > splat4d(DBL_MIN);
+    vec4d A = select4d(positive,
+        exp4d(log4d(select4d(positive, w, one)) * splat4d(1.0/3.0)), one);
+    vec4d B = a / (splat4d(3.0)*A);
+    vec4d s_parabolic = select4d(positive, b / (A*A + A*B + B*B), zero) - sigma0;
+
+    vec4d k = sqrt4d(abs4d(alpha));
+    vec4d ecos0 = one - alpha*r0, esin0 = k*sigma0;
+    vec4d dM = sqrt_mu * k*k*k * time;
+
+    vec4l parabolic = parabolic_alpha |
+        (monotonic & (abs4d(alpha) * s_parabolic*s_parabolic < one));
+    vec4l hyperbolic = ~parabolic & (alpha < zero);
+    vec4l elliptic = ~parabolic & ~(alpha < zero);
+    vec4d s = s_parabolic;
+
+    // the other starters only when a lane takes them
+    if(any4l(elliptic)) {
+        vec4d sin_dM, cos_dM;
+        sincos4d(dM, &sin_dM, &cos_dM);
+        vec4d esin = esin0*cos_dM + ecos0*sin_dM;
+        vec4d ecos = ecos0*cos_dM - esin0*sin_dM;
+        vec4d e = sqrt4d(ecos0*ecos0 + esin0*esin0);
+        vec4d dE = (esin - esin0) / (one - ecos);
+        dE = select4d(dE < -e - esin0, -e - esin0, dE);
+        dE = select4d(dE > e - esin0, e - esin0, dE);
+        s = select4d(elliptic, (dM + dE) / k, s);
+    }
+
+    if(!any4l(hyperbolic))
+        return s;
+
+    vec4d b1 = -alpha*r0, esin0_dM = esin0*dM;
+    vec4d s_short = splat4d(2.0)*dM /
+        (b1 + sqrt4d(abs4d(b1*b1 + splat4d(2.0)*esin0_dM))) / k;
+    vec4l short_arc = (abs4d(dM) < one) & (esin0_dM >= zero) &
+        (dM*dM*ecos0 < b1*b1*b1);
+    s = select4d(hyperbolic & short_arc, s_short, s);
+
+    vec4l asymptotic = hyperbolic & ~short_arc & (abs4d(dM) >= one);
+    if(any4l(asymptotic)) {
+        vec4d st = sign4d(time);
+        vec4d x = splat4d(-2.0) * alpha * splat4d(mu) * time /
+            (sqrt_mu*sigma0 + st * sqrt4d(splat4d(mu) / -alpha) * (one - alpha*r0));
+        vec4l valid = x > splat4d(DBL_MIN);
+        vec4d s_asymptotic = st * sqrt4d(one / -alpha) *
+            log4d(select4d(valid, x, one));
+        asymptotic = asymptotic & valid & (s_asymptotic * time > zero);
+        s = select4d(asymptotic, s_asymptotic, s);
+    }
+
+    vec4l scalar = hyperbolic & ~short_arc & ~asymptotic;
+    if(any4l(scalar))
+        for(int lane = 0; lane < 4; ++lane)
+            if(scalar[lane])
+                s[lane] = universal_guess_s(
+                    mu, alpha[lane], r0[lane], sigma0[lane], time[lane]);
+
+    return s;
+}
+
+// two independent groups of lanes in flight, the iteration is latency bound
+#define UNIVERSAL_GROUPS 2
+
+static inline void universal_iterate_s4d(
+    int groups,
+    vec4d sqrt_mu,
+    const vec4d *alpha,
+    const vec4d *r0, const vec4d *sigma0,
+    vec4d *s, const vec4d *time,
+    int max_steps, double threshold,
+    vec4d (*u)[3]) __attribute__((always_inline));
+static inline void universal_iterate_s4d(
+    int groups,
+    vec4d sqrt_mu,
+    const vec4d *alpha,
+    const vec4d *r0, const vec4d *sigma0,
+    vec4d *s, const vec4d *time,
+    int max_steps, double threshold,
+    vec4d (*u)[3]) {
+    // see universal_solve_s, s is the guess on input, converged lanes keep
+    // their value, f0, f1 and f2 are scaled by sqrt(mu) (same step),
+    // u[h][k] = s^k c_k(alpha s^2) at the result
+    vec4l active[UNIVERSAL_GROUPS], steps[UNIVERSAL_GROUPS];
+    for(int h = 0; h < groups; ++h) {
+        active[h] = (vec4l){ -1, -1, -1, -1 }; // all lanes iterating
+        steps[h] = (vec4l){ 0, 0, 0, 0 };
+        u[h][0] = u[h][1] = u[h][2] = splat4d(0.0);
+    }
+
+    for(int step = 0; step < max_steps; ++step) {
+        vec4l any = { 0, 0, 0, 0 };
+
+        for(int h = 0; h < groups; ++h) {
+            vec4d cs[4];
+            stumpff_fast4d(alpha[h] * s[h]*s[h], cs);
+
+            vec4d f0 = r0[h] * s[h] * cs[1] + sigma0[h] * s[h]*s[h] * cs[2] +
+                s[h]*s[h]*s[h] * cs[3] - sqrt_mu * time[h];
+            vec4d f1 = r0[h] * cs[0] + sigma0[h] * s[h] * cs[1] + s[h]*s[h] * cs[2];
+            vec4d f2 = sigma0[h] * cs[0] +
+                (splat4d(1.0) - alpha[h] * r0[h]) * s[h] * cs[1];
+
+            const double N = 5.0; // laguerre-conway magic constant
+            vec4d ds = splat4d(-N) * f0 /
+                (f1 + sign4d(f1) * sqrt4d(abs4d(
+                    splat4d(square(N-1.0)) * f1*f1 - splat4d(N*(N-1.0)) * f0*f2)));
+
+            // Stumpff values carried to s + ds, see universal_u_step
+            vec4d h2 = splat4d(0.5) * ds*ds;
+            vec4d u0 = cs[0], u1 = s[h] * cs[1], u2 = s[h]*s[h] * cs[2];
+            u[h][0] = select4d(active[h], u0 - alpha[h] * (ds*u1 + h2*u0), u[h][0]);
+            u[h][1] = select4d(active[h], u1 + ds*u0 - alpha[h] * h2*u1, u[h][1]);
+            u[h][2] = select4d(active[h], u2 + ds*u1 + h2*u0, u[h][2]);
+
+            s[h] = s[h] + select4d(active[h], ds, splat4d(0.0));
+            steps[h] = steps[h] - active[h]; // all ones is -1
+            active[h] = active[h] & (ds*ds >= splat4d(threshold));
+            any = any | active[h];
+        }
+
+        if(!any4l(any))
+            break;
+    }
+
+    if(universal_histogram)
+        for(int h = 0; h < groups; ++h)
+            for(int lane = 0; lane < 4; ++lane)
+                universal_count_steps(steps[h][lane]);
+
+    for(int h = 0; h < groups; ++h) {
+        if(!any4l(active[h]))
+            continue;
+
+        // not converged, ds^3 may be large
+        vec4d cs[4];
+        stumpff_fast4d(alpha[h] * s[h]*s[h], cs);
+        u[h][0] = select4d(active[h], cs[0], u[h][0]);
+        u[h][1] = select4d(active[h], s[h] * cs[1], u[h][1]);
+        u[h][2] = select4d(active[h], s[h]*s[h] * cs[2], u[h][2]);
+    }
+}
+
+static inline void universal_propagate4d(
+    int groups,
+    double mu,
+    double *x, double *y, double *z,
+    double *vx, double *vy, double *vz,
+    const double *dt) __attribute__((always_inline));
+static inline void universal_propagate4d(
+    int groups,
+    double mu,
+    double *x, double *y, double *z,
+    double *vx, double *vy, double *vz,
+    const double *dt) {
+    // 4*groups states, see universal_propagate
+    vec4d sqrt_mu = splat4d(sqrt(mu));
+    vec4d alpha[UNIVERSAL_GROUPS], r0[UNIVERSAL_GROUPS], sigma0[UNIVERSAL_GROUPS];
+    vec4d s[UNIVERSAL_GROUPS], time[UNIVERSAL_GROUPS];
+
+    for(int h = 0; h < groups; ++h) {
+        vec4d px = load4d(x + 4*h), py = load4d(y + 4*h), pz = load4d(z + 4*h);
+        vec4d wx = load4d(vx + 4*h), wy = load4d(vy + 4*h), wz = load4d(vz + 4*h);
+        time[h] = load4d(dt + 4*h);
+
+        r0[h] = sqrt4d(px*px + py*py + pz*pz);
+        sigma0[h] = (px*wx + py*wy + pz*wz) / sqrt_mu;
+        alpha[h] = splat4d(2.0) / r0[h] - (wx*wx + wy*wy + wz*wz) / splat4d(mu);
+        s[h] = universal_guess_s4d(mu, alpha[h], r0[h], sigma0[h], time[h]);
+    }
+
+    vec4d u[UNIVERSAL_GROUPS][3];
+    universal_iterate_s4d(groups, sqrt_mu, alpha, r0, sigma0, s, time,
+        UNIVERSAL_MAX_STEPS, DBL_EPSILON, u);
+
+    for(int h = 0; h < groups; ++h) {
+        vec4d fg[6];
+        universal_fg4d(sqrt_mu, r0[h], sigma0[h], alpha[h], u[h], fg);
+        vec4d f = fg[2], g = fg[3], fdot = fg[4], gdot = fg[5];
+
+        vec4d px = load4d(x + 4*h), py = load4d(y + 4*h), pz = load4d(z + 4*h);
+        vec4d wx = load4d(vx + 4*h), wy = load4d(vy + 4*h), wz = load4d(vz + 4*h);
+        store4d(x + 4*h, f*px + g*wx);
+        store4d(y + 4*h, f*py + g*wy);
+        store4d(z + 4*h, f*pz + g*wz);
+        store4d(vx + 4*h, fdot*px + gdot*wx);
+        store4d(vy + 4*h, fdot*py + gdot*wy);
+        store4d(vz + 4*h, fdot*pz + gdot*wz);
+    }
+}
+#endif
+
+void universal_propagate_n(
+    double mu,
+    double *x, double *y, double *z,
+    double *vx, double *vy, double *vz,
+    const double *dt,
+    size_t n) {
+    size_t i = 0;
+
+#ifndef TWOBODY_NO_SIMD
+    for(; i + 4*UNIVERSAL_GROUPS <= n; i += 4*UNIVERSAL_GROUPS)
+        universal_propagate4d(UNIVERSAL_GROUPS, mu,
+            x + i, y + i, z + i, vx + i, vy + i, vz + i, dt + i);
+    for(; i + 4 <= n; i += 4)
+        universal_propagate4d(1, mu,
+            x + i, y + i, z + i, vx + i, vy + i, vz + i, dt + i);
+#endif
+
+    for(; i < n; ++i) {
+        double pos[3] = { x[i], y[i], z[i] }, vel[3] = { vx[i], vy[i], vz[i] };
+        universal_propagate(mu, pos, vel, dt[i], pos, vel);
+
+        x[i] = pos[0]; y[i] = pos[1]; z[i] = pos[2];
+        vx[i] = vel[0]; vy[i] = vel[1]; vz[i] = vel[2];
+    }
+}
@@ -128,6 +128,8 @@ static bool numtest_run_tests(const struct numtest_args *args) {
         uint64_t num = 1 << 23;
         uint64_t first = args->first;
         uint64_t last = args->last != 0 ? args->last : num;
+        if(test_case->max_cases != 0 && last - first >= test_case->max_cases)
+            last = first + test_case->max_cases - 1;
 
         time_t time_test_begin = time(0);
 
@@ -26,6 +26,7 @@ struct numtest_case {
     numtest_callback *func;
     int num_params;
     void *extra_args;
+    uint64_t max_cases; // slow tests, 0 for no limit
 };
 
 extern uint64_t numtest_num_cases_default;
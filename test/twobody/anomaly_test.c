@@ -47,6 +47,83 @@ void anomaly_test(
     ASSERT_RANGEF(E3, -maxE, maxE, "Eccentric anomaly within range");
     ASSERT_EQF(M, anomaly_eccentric_to_mean(e, E3), "True -> Eccentric");
 
+    double E5 = anomaly_mean_to_eccentric_fixed(e, M);
+    ASSERT(isfinite(E5), "Eccentric anomaly not NaN (fixed steps)");
+    ASSERT_EQF(E3, E5, "Iterative and fixed step solvers are equal");
+    // anomaly_fixed_steps converges as far as rounding in Kepler's equation
+    // allows, an error of eps*(|E| + |M|) in M moves E by that times dE/dM
+    ASSERT(fabs(E3 - E5) <= 4.0 * DBL_EPSILON * (fmax(1.0, fabs(E3)) +
+            (fabs(E3) + fabs(M)) * fabs(anomaly_dEdM(e, E3))),
+        "Fixed step solver converged");
+
+    const double tol = 1.0e-6;
+    double E6 = anomaly_mean_to_eccentric_tol(e, M, tol);
+    ASSERT(isfinite(E6), "Eccentric anomaly not NaN (tolerance)");
+    ASSERT(fabs(E3 - E6) <= 4.0 * tol * fmax(1.0, fabs(E3)),
+        "Iterative solver within tolerance");
+
+    if(conic_elliptic(e)) {
+        double E4 = anomaly_eccentric_markley(e, M);
+        ASSERT(isfinite(E4), "Eccentric anomaly not NaN (Markley)");
+        ASSERT_EQF(E3, E4, "Iterative and Markley solvers are equal");
+        ASSERT_EQF(M, anomaly_eccentric_to_mean(e, E4),
+            "Mean -> Eccentric (Markley)");
+
+        // full double accuracy, the near-parabolic band never uses Markley
+        double Elc = anomaly_eccentric_iterate(e, M, M, 0); // Laguerre-Conway
+        if(!anomaly_is_near_parabolic(e, M))
+            ASSERT(fabs(Elc - E4) <= 16.0 * DBL_EPSILON * fmax(1.0, fabs(Elc)),
+                "Markley solver within a few ulp");
+    }
+
+    if(conic_hyperbolic(e)) {
+        double Mfar = M * 1.0e12; // e*sinh(H) overflows near H = 710
+        double Efar = anomaly_mean_to_eccentric(e, Mfar);
+        ASSERT(isfinite(Efar), "Hyperbolic anomaly not NaN (far)");
+        ASSERT_EQF(Mfar, anomaly_eccentric_to_mean(e, Efar),
+            "Mean -> Hyperbolic (far)");
+
+        // b*b of the cubic starter overflows above 1e154
+        double Mhuge = sign(t) * pow(10.0, 150.0 + 150.0 * fabs(t)); // 1e150..1e300
+        double Ehuge = anomaly_mean_to_eccentric(e, Mhuge);
+        ASSERT(isfinite(Ehuge) && fabs(Ehuge) > 300.0,
+            "Hyperbolic anomaly not NaN or zero (huge)");
+        ASSERT_EQF(anomaly_eccentric_to_mean(e, Ehuge) / Mhuge, 1.0, // M*M overflows
+            "Mean -> Hyperbolic (huge)");
+    }
+
+    // series for near-circular orbits, continuous at the switchover
+    double Ms = t * 2.5 * M_PI; // more than one period, never at +-pi
+    double es = params[0] * ANOMALY_SERIES;
+    ASSERT_EQF(anomaly_eccentric_series(es, Ms),
+        anomaly_eccentric_iterate(es, Ms, Ms, 0),
+        "Eccentric anomaly series and iteration");
+    ASSERT_EQF(anomaly_true_series(es, Ms),
+        anomaly_eccentric_to_true(es, anomaly_eccentric_iterate(es, Ms, Ms, 0)),
+        "True anomaly series and iteration");
+
+    double ebelow = nextafter(ANOMALY_SERIES, 0.0), eabove = ANOMALY_SERIES;
+    ASSERT_EQF(anomaly_mean_to_eccentric(ebelow, Ms),
+        anomaly_mean_to_eccentric(eabove, Ms),
+        "Eccentric anomaly continuous at series threshold");
+    ASSERT_EQF(anomaly_mean_to_true(ebelow, Ms),
+        anomaly_mean_to_true(eabove, Ms),
+        "True anomaly continuous at series threshold");
+
+    // near-parabolic band around e = 1
+    double enp = 1.0 + (-1.0 + params[0] * 2.0) * ANOMALY_NEAR_PARABOLIC;
+    if(!conic_parabolic(enp)) {
+        double Mnp = t * anomaly_eccentric_to_mean(enp, maxE);
+        double Enp = anomaly_near_parabolic(enp, Mnp, 0);
+        ASSERT(isfinite(Enp), "Eccentric anomaly not NaN (near-parabolic)");
+        ASSERT_EQF(Mnp, anomaly_eccentric_to_mean(enp, Enp),
+            "Mean -> Eccentric (near-parabolic)");
+
+        if(anomaly_is_near_parabolic(enp, Mnp))
+            ASSERT_EQF(Enp, anomaly_mean_to_eccentric(enp, Mnp),
+                "Near-parabolic solver is used");
+    }
+
     double M2 = anomaly_eccentric_to_mean(e, E);
     ASSERT(isfinite(M2), "Mean anomaly not NaN");
     ASSERT_RANGEF(M2, -maxM, maxM, "Mean anomaly within range");
@@ -125,3 +202,173 @@ void anomaly_test(
         }
     }
 }
+
+static int anomaly_eqf_apoapsis(double a, double b) {
+    // -pi and pi are the same angle, sin(pi) rounds to either side
+    return EQF(a, b) || (EQF(fabs(a), M_PI) && EQF(fabs(b), M_PI));
+}
+
+void anomaly_batch_test(
+    double *params,
+    int num_params,
+    void *extra_args,
+    struct numtest_ctx *test_ctx) {
+    (void)extra_args;
+
+    ASSERT(num_params == 2, "num_params");
+
+    // two elliptic batches, a hyperbolic batch, a mixed batch and a remainder
+    const int n = 19;
+    double e[n], M[n], E[n];
+
+    for(int i = 0; i < n; ++i) {
+        double t = -1.0 + fmod(params[1] + i / (double)n, 1.0) * 2.0;
+
+        e[i] = i < 8 ?
+            params[0] * (1.0 - i / 16.0) :      // elliptic
+            (i < 12 ?
+                1.0 + 1.0e-4 + params[0] * (i - 7) : // hyperbolic
+                params[0] * 2.0 * (i - 11) / 4.0);   // any conic
+
+        double maxM = anomaly_eccentric_to_mean(e[i], M_PI);
+        M[i] = t * maxM * (1 + i % 3); // some more than one period
+    }
+
+    enum anomaly_solver solver = anomaly_get_solver();
+    enum anomaly_solver solvers[] = {
+        ANOMALY_SOLVER_LAGUERRE_CONWAY,
+        ANOMALY_SOLVER_MARKLEY,
+        ANOMALY_SOLVER_FIXED
+    };
+
+    for(int s = 0; s < (int)(sizeof(solvers)/sizeof(*solvers)); ++s) {
+        anomaly_set_solver(solvers[s]);
+        anomaly_mean_to_eccentric_n(e, M, E, n);
+
+        for(int i = 0; i < n; ++i) {
+            double E2 = anomaly_mean_to_eccentric(e[i], M[i]);
+
+            ASSERT(isfinite(E[i]),
+                "Eccentric anomaly not NaN (solver %d, batch %d)", s, i);
+            ASSERT_EQF(E[i], E2,
+                "Batch and scalar eccentric anomaly (solver %d, batch %d)",
+                s, i);
+            ASSERT_EQF(M[i], anomaly_eccentric_to_mean(e[i], E[i]),
+                "Mean -> Eccentric (solver %d, batch %d)", s, i);
+        }
+
+        // coarse tolerance
+        const double tol = 1.0e-6;
+        anomaly_mean_to_eccentric_n_tol(e, M, E, n, tol);
+
+        for(int i = 0; i < n; ++i) {
+            double E2 = anomaly_mean_to_eccentric(e[i], M[i]);
+
+            ASSERT(fabs(E[i] - E2) <= 4.0 * tol * fmax(1.0, fabs(E2)),
+                "Batch eccentric anomaly within tolerance (solver %d, batch %d)",
+                s, i);
+
+            // fixed steps ignore tol, as the scalar solver does
+            if(solvers[s] == ANOMALY_SOLVER_FIXED)
+                ASSERT(fabs(E[i] - E2) <= 1.0e-12 * fmax(1.0, fabs(E2)),
+                    "Batch eccentric anomaly fixed steps (batch %d)", i);
+        }
+    }
+
+    anomaly_set_solver(solver);
+
+    // conversions, true anomaly from the scalar functions
+    double f[n], out[n];
+    for(int i = 0; i < n; ++i)
+        f[i] = anomaly_mean_to_true(e[i], M[i]);
+
+    anomaly_mean_to_true_n(e, M, out, n);
+    for(int i = 0; i < n; ++i)
+        ASSERT(anomaly_eqf_apoapsis(out[i], f[i]),
+            "Batch and scalar mean -> true (batch %d)", i);
+
+    anomaly_mean_to_eccentric_n(e, M, E, n);
+    anomaly_eccentric_to_true_n(e, E, out, n);
+    for(int i = 0; i < n; ++i)
+        ASSERT(anomaly_eqf_apoapsis(out[i], anomaly_eccentric_to_true(e[i], E[i])),
+            "Batch and scalar eccentric -> true (batch %d)", i);
+
+    anomaly_true_to_eccentric_n(e, f, out, n);
+    for(int i = 0; i < n; ++i)
+        ASSERT(anomaly_eqf_apoapsis(out[i], anomaly_true_to_eccentric(e[i], f[i])),
+            "Batch and scalar true -> eccentric (batch %d)", i);
+
+    anomaly_true_to_mean_n(e, f, out, n);
+    for(int i = 0; i < n; ++i)
+        ASSERT(anomaly_eqf_apoapsis(out[i], anomaly_true_to_mean(e[i], f[i])),
+            "Batch and scalar true -> mean (batch %d)", i);
+}
+
+static double anomaly_float_tolerance(double e, double E) {
+    // float e: relative error of 1 - e is FLT_EPSILON/|1 - e|
+    double scale = conic_parabolic(e) ? 1.0 : fmin(1.0, fabs(1.0 - e));
+    return 8.0 * FLT_EPSILON * fmax(1.0, fabs(E)) / scale;
+}
+
+void anomaly_float_test(
+    double *params,
+    int num_params,
+    void *extra_args,
+    struct numtest_ctx *test_ctx) {
+    (void)extra_args;
+
+    ASSERT(num_params == 2, "num_params");
+
+    double e = params[0] * 2.0;
+    double t = -1.0 + params[1] * 2.0;
+    double M = t * anomaly_eccentric_to_mean(e, M_PI);
+
+    double E = anomaly_mean_to_eccentric(e, M);
+    float Ef = anomaly_mean_to_eccentric_f(e, M);
+    ASSERT(isfinite(Ef), "Eccentric anomaly not NaN (float)");
+    ASSERT(fabs(Ef - E) <= anomaly_float_tolerance(e, E),
+        "Double and float eccentric anomaly");
+
+    double Emixed = anomaly_mean_to_eccentric_mixed(e, M);
+    ASSERT(isfinite(Emixed), "Eccentric anomaly not NaN (mixed)");
+    ASSERT_EQF(E, Emixed, "Double and mixed precision eccentric anomaly");
+
+    if(conic_hyperbolic(e)) {
+        // far from periapsis, 1e1..1e30 (b*b of the cubic starter overflows)
+        double Mfar = sign(t) * pow(10.0, 1.0 + 29.0 * fabs(t));
+        double Efar = anomaly_mean_to_eccentric(e, Mfar);
+        float Effar = anomaly_mean_to_eccentric_f(e, Mfar);
+        ASSERT(fabs(Effar - Efar) <= anomaly_float_tolerance(e, Efar),
+            "Double and float hyperbolic anomaly (far)");
+        ASSERT_EQF(Efar, anomaly_mean_to_eccentric_mixed(e, Mfar),
+            "Double and mixed precision hyperbolic anomaly (far)");
+    }
+
+    // an elliptic batch, a mixed batch and a remainder
+    const int n = 19;
+    double ee[n], MM[n], EE[n];
+    float eef[n], MMf[n], EEf[n];
+
+    for(int i = 0; i < n; ++i) {
+        ee[i] = i < 8 ?
+            params[0] * (1.0 - i / 16.0) :
+            params[0] * 2.0 * (i - 7) / 11.0;
+        MM[i] = t * anomaly_eccentric_to_mean(ee[i], M_PI) * (1 + i % 3);
+        eef[i] = ee[i];
+        MMf[i] = MM[i];
+    }
+
+    anomaly_mean_to_eccentric_nf(eef, MMf, EEf, n);
+    anomaly_mean_to_eccentric_mixed_n(ee, MM, EE, n);
+
+    for(int i = 0; i < n; ++i) {
+        double E2 = anomaly_mean_to_eccentric(eef[i], MMf[i]);
+
+        ASSERT(isfinite(EEf[i]) && isfinite(EE[i]),
+            "Eccentric anomaly not NaN (batch %d)", i);
+        ASSERT(fabs(EEf[i] - E2) <= anomaly_float_tolerance(eef[i], E2),
+            "Double and float eccentric anomaly (batch %d)", i);
+        ASSERT_EQF(anomaly_mean_to_eccentric(ee[i], MM[i]), EE[i],
+            "Double and mixed precision eccentric anomaly (batch %d)", i);
+    }
+}
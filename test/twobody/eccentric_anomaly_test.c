@@ -114,6 +114,11 @@ void eccentric_anomaly_test(
         isfinite(xdot) && isfinite(ydot),
         "Position and velocity not NaN");
 
+    double xs, ys, xsdot, ysdot;
+    eccentric_state_2d(mu, p, e, E, &xs, &ys, &xsdot, &ysdot);
+    ASSERT(EQF(x, xs) && EQF(y, ys) && EQF(xdot, xsdot) && EQF(ydot, ysdot),
+        "Fused position and velocity");
+
     ASSERT_EQF(x*x + y*y, r*r,
         "Position magnitude");
     ASSERT_EQF(xdot*xdot + ydot*ydot, v*v,
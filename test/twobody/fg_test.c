@@ -140,4 +140,44 @@ void fg_test(
         "fg identity with time (universal)");
     ASSERT_EQF(t2-t1, -universal_g_t(mu, -gs, s, cs),
         "fg g function time identity (universal)");
+
+    // universal variables, fused
+    double fg[6];
+    universal_fg(mu, r1, sigma1, alpha, s, cs, fg);
+
+    ASSERT_EQF(fg[0], r2, "fg radius (universal fused)");
+    ASSERT_EQF(fg[1], universal_sigma(alpha, r1, sigma1, s, cs),
+        "fg sigma (universal fused)");
+    ASSERT(eqv4d(splat4d(fg[2]) * pos1 + splat4d(fg[3]) * vel1, pos2),
+        "fg position identity (universal fused)");
+    ASSERT(eqv4d(splat4d(fg[4]) * pos1 + splat4d(fg[5]) * vel1, vel2),
+        "fg velocity identity (universal fused)");
+
+    // a batch and a remainder of shorter arcs
+    const int batch = 7;
+    double r0s[batch], sigma0s[batch], alphas[batch], ss[batch], fgs[6*batch];
+    for(int i = 0; i < batch; ++i) {
+        r0s[i] = r1;
+        sigma0s[i] = sigma1;
+        alphas[i] = alpha;
+        ss[i] = s * (i + 1) / batch;
+    }
+
+    universal_fg_n(mu, r0s, sigma0s, alphas, ss, fgs, batch);
+
+    for(int i = 0; i < batch; ++i) {
+        double csi[4], fgi[6];
+        stumpff_fast(alpha * ss[i]*ss[i], csi);
+        universal_fg(mu, r1, sigma1, alpha, ss[i], csi, fgi);
+
+        // f, g, fdot and gdot cancel in the state, compare that
+        ASSERT_EQF(fgs[6*i], fgi[0],
+            "fg radius batch and scalar (universal fused, batch %d)", i);
+        ASSERT(eqv4d(splat4d(fgs[6*i + 2]) * pos1 + splat4d(fgs[6*i + 3]) * vel1,
+                splat4d(fgi[2]) * pos1 + splat4d(fgi[3]) * vel1),
+            "fg position batch and scalar (universal fused, batch %d)", i);
+        ASSERT(eqv4d(splat4d(fgs[6*i + 4]) * pos1 + splat4d(fgs[6*i + 5]) * vel1,
+                splat4d(fgi[4]) * pos1 + splat4d(fgi[5]) * vel1),
+            "fg velocity batch and scalar (universal fused, batch %d)", i);
+    }
 }
@@ -0,0 +1,87 @@
+#include <twobody/conic.h>
+#include <twobody/anomaly.h>
+#include <twobody/kepler.h>
+#include <twobody/orbit.h>
+#include <twobody/math_utils.h>
+
+#include <math.h>
+#include <float.h>
+
+#include "../numtest.h"
+
+void kepler_ctx_test(
+    double *params,
+    int num_params,
+    void *extra_args,
+    struct numtest_ctx *test_ctx) {
+    (void)extra_args;
+    ASSERT(num_params == 4, "");
+
+    double mu = 1.0 + params[0] * 1.0e10;
+    double p = 1.0 + params[1] * 1.0e10;
+    double e = params[2] * 2.0;
+    double t = (-1.0 + params[3] * 2.0) * 3.0; // up to three periods
+
+    struct kepler_ctx ctx;
+    kepler_ctx_init(&ctx, e);
+    ASSERT_EQF(e, kepler_ctx_eccentricity(&ctx), "Eccentricity");
+
+    double maxM = conic_closed(e) ?
+        M_PI : anomaly_eccentric_to_mean(e, M_PI);
+    double M = t * maxM;
+
+    double E = anomaly_mean_to_eccentric(e, M);
+    double E2 = kepler_ctx_mean_to_eccentric(&ctx, M);
+    ASSERT(isfinite(E2), "Eccentric anomaly not NaN");
+    ASSERT_EQF(E, E2, "Kepler context and solver are equal");
+    ASSERT_EQF(M, anomaly_eccentric_to_mean(e, E2), "Mean -> Eccentric");
+
+    if(conic_elliptic(e)) {
+        double E0 = kepler_ctx_guess(&ctx, M);
+        ASSERT(fabs(E0 - E) < 1.0e-3, "Kepler context initial guess");
+    }
+
+    // graded towards e = 1 - 1e-7 and periapsis, where E(M) is close to a
+    // cube root, one refinement step at full precision
+    double e_step = 1.0 - pow(10.0, -7.0 * params[2]);
+    double M_step = anomaly_eccentric_to_mean(e_step,
+        M_PI * cube(-1.0 + 2.0 * fmod(params[3] + params[0], 1.0)));
+    struct kepler_ctx ctx_step;
+    kepler_ctx_init(&ctx_step, e_step);
+    double E_step = anomaly_mean_to_eccentric(e_step, M_step);
+
+    unsigned long histogram[ANOMALY_MAX_STEPS + 1] = { 0 };
+    anomaly_set_histogram(histogram);
+    double E_ctx = kepler_ctx_mean_to_eccentric(&ctx_step, M_step);
+    anomaly_set_histogram(0);
+
+    ASSERT(histogram[KEPLER_CTX_STEPS] == 1,
+        "Kepler context refinement steps (e = %g)", e_step);
+    ASSERT(fabs(E_ctx - E_step) <= 16.0 * DBL_EPSILON * fmax(1.0, fabs(E_step)),
+        "Kepler context one step precision (e = %g)", e_step);
+
+    // attach context to orbit
+    struct orbit orbit;
+    orbit_from_elements(&orbit, mu, p, e, 0.0, 0.0, 0.0, 0.0);
+    ASSERT(orbit_kepler_ctx(&orbit) == 0, "No Kepler context attached");
+
+    double n = conic_mean_motion(mu, p, e);
+    vec4d pos, vel, pos_ctx, vel_ctx;
+    orbit_state_time(&orbit, (double*)&pos, (double*)&vel, M / n);
+
+    orbit_set_kepler_ctx(&orbit, &ctx);
+    ASSERT(orbit_kepler_ctx(&orbit) == &ctx, "Kepler context attached");
+    orbit_state_time(&orbit, (double*)&pos_ctx, (double*)&vel_ctx, M / n);
+
+    ASSERT(eqv4d(pos, pos_ctx) && eqv4d(vel, vel_ctx),
+        "Orbit state with Kepler context");
+
+    // near-parabolic band, E - e*sin(E) cancels near periapsis
+    double e_band = 0.9901 + 0.0098 * params[2]; // strictly inside
+    double M_band = (-1.0 + 2.0 * params[3]) * 0.1;
+    kepler_ctx_init(&ctx, e_band);
+    double E_band = anomaly_mean_to_eccentric(e_band, M_band);
+    ASSERT(fabs(kepler_ctx_mean_to_eccentric(&ctx, M_band) - E_band) <=
+        8.0 * DBL_EPSILON * fabs(E_band),
+        "Kepler context near-parabolic");
+}
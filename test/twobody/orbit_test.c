@@ -3,6 +3,7 @@
 #include <twobody/anomaly.h>
 #include <twobody/true_anomaly.h>
 #include <twobody/orientation.h>
+#include <float.h>
 
 #include "../numtest.h"
 
@@ -140,6 +141,24 @@ void orbit_from_state_test(
         "Orbit position (eccentric anomaly)");
     ASSERT(eqv4d(vel, orbit_velocity_eccentric(&orbit, E)),
         "Orbit velocity (eccentric anomaly)");
+
+    vec4d pos_t, vel_t;
+    orbit_state_time(&orbit, (double*)&pos_t, (double*)&vel_t, t);
+    ASSERT(eqv4d(pos, pos_t) && eqv4d(vel, vel_t),
+        "Orbit state (time)");
+
+    // batch, 4 lanes and a remainder
+    double fs[5] = { f, -f, 0.5*f, 0.25*f, -0.5*f };
+    vec4d pos_n[5], vel_n[5];
+    orbit_state_true_n(&orbit, (double*)pos_n, (double*)vel_n, fs, 5);
+    ASSERT(eqv4d(pos, pos_n[0]) && eqv4d(vel, vel_n[0]),
+        "Orbit state (true anomaly, batch)");
+    for(int k = 0; k < 5; ++k) {
+        vec4d pos_f, vel_f;
+        orbit_state_true(&orbit, (double*)&pos_f, (double*)&vel_f, fs[k]);
+        ASSERT(eqv4d(pos_f, pos_n[k]) && eqv4d(vel_f, vel_n[k]),
+            "Orbit state (true anomaly, batch lane %d)", k);
+    }
 }
 
 void orbit_from_elements_test(
@@ -181,6 +200,22 @@ void orbit_from_elements_test(
     ASSERT(orbit_elliptic(&orbit) == conic_elliptic(e),
         "Orbit is elliptic");
 
+    if(!conic_parabolic(e)) { // infinite axes
+        double pp = orbit_semi_latus_rectum(&orbit);
+        double ee = orbit_eccentricity(&orbit);
+        // e = 0 comes back as about sqrt(DBL_EPSILON) from the invariants
+        ASSERT(orbit.type == conic_type(ee),
+            "Orbit conic type");
+        ASSERT_EQF(orbit.semi_major_axis, conic_semi_major_axis(pp, ee),
+            "Orbit semi-major axis");
+        ASSERT_EQF(orbit.semi_minor_axis, conic_semi_minor_axis(pp, ee),
+            "Orbit semi-minor axis");
+    }
+    ASSERT_EQF(orbit.periapsis, conic_periapsis(p, e),
+        "Orbit periapsis");
+    ASSERT_EQF(orbit.mean_motion, conic_mean_motion(mu, p, e),
+        "Orbit mean motion");
+
     ASSERT_EQF(i,
         orientation_inclination(
             orbit.major_axis,
@@ -268,3 +303,202 @@ void orbit_radial_test(
 
     // TODO: implement and test radial trajectories
 }
+
+void orbit_cursor_test(
+    double *params,
+    int num_params,
+    void *extra_args,
+    struct numtest_ctx *test_ctx) {
+    (void)extra_args;
+    ASSERT(num_params == 5, "");
+
+    double mu = 1.0 + params[0] * 1.0e10;
+    double p = 1.0 + params[1] * 1.0e10;
+    double e = params[2] * 4.0;
+
+    double n = conic_mean_motion(mu, p, e);
+    double maxM = conic_closed(e) ?
+        M_PI : anomaly_eccentric_to_mean(e, M_PI);
+    double t0 = (-1.0 + 2.0 * params[3]) * maxM / n;
+    double dt = (1.0 + params[4] * 99.0) * (1.0 / 360.0) / n; // 0.16..16 deg
+
+    struct orbit orbit;
+    orbit_from_elements(&orbit, mu, p, e, 0.0, 0.0, 0.0, 0.0);
+
+    struct orbit_cursor cursor;
+    orbit_cursor_init(&cursor, &orbit, t0);
+
+    for(int step = 0; step < 16; ++step) {
+        double t = t0 + step * dt;
+
+        vec4d pos, vel, pos_cursor, vel_cursor;
+        orbit_state_time(&orbit, (double*)&pos, (double*)&vel, t);
+        orbit_cursor_advance(&cursor,
+            (double*)&pos_cursor, (double*)&vel_cursor, t);
+
+        ASSERT(eqv4d(pos, pos_cursor) && eqv4d(vel, vel_cursor),
+            "Orbit cursor state (step %d)", step);
+    }
+
+    // dense series (0.01..1 deg): one correction and the convergence check
+    unsigned long histogram[ANOMALY_MAX_STEPS + 1] = { 0 };
+    anomaly_set_histogram(histogram);
+    orbit_cursor_init(&cursor, &orbit, t0);
+    for(int step = 0; step < 16; ++step) {
+        vec4d pos_cursor, vel_cursor;
+        orbit_cursor_advance(&cursor,
+            (double*)&pos_cursor, (double*)&vel_cursor, t0 + step * dt/16.0);
+    }
+    anomaly_set_histogram(0);
+
+    unsigned long solves = 0, steps = 0;
+    for(int k = 0; k <= ANOMALY_MAX_STEPS; ++k) {
+        solves += histogram[k];
+        steps += k * histogram[k];
+    }
+    ASSERT(steps <= 2.5 * solves,
+        "Orbit cursor steps per solve (%lu solves, %lu steps)", solves, steps);
+
+    // near-parabolic band, E - e*sin(E) cancels near periapsis
+    double e_band = 0.9901 + 0.0098 * params[2]; // strictly inside
+    struct orbit orbit_band;
+    orbit_from_elements(&orbit_band, mu, p, e_band, 0.0, 0.0, 0.0, 0.0);
+    double n_band = conic_mean_motion(mu, p, e_band);
+    double t_band = (-1.0 + 2.0 * params[3]) * 0.1 / n_band;
+    orbit_cursor_init(&cursor, &orbit_band, t_band);
+    for(int step = 0; step < 16; ++step) {
+        vec4d pos_cursor, vel_cursor;
+        orbit_cursor_advance(&cursor,
+            (double*)&pos_cursor, (double*)&vel_cursor,
+            t_band + step * dt * n/n_band / 16.0);
+
+        double E = anomaly_mean_to_eccentric(
+            cursor.orbit->eccentricity, cursor.mean_anomaly);
+        ASSERT(fabs(cursor.eccentric_anomaly - E) <= 8.0 * DBL_EPSILON * fabs(E),
+            "Orbit cursor near-parabolic (step %d)", step);
+    }
+}
+
+void orbit_float_test(
+    double *params,
+    int num_params,
+    void *extra_args,
+    struct numtest_ctx *test_ctx) {
+    (void)extra_args;
+    ASSERT(num_params == 4, "");
+
+    double mu = 1.0 + params[0] * 1.0e10;
+    double p = 1.0 + params[1] * 1.0e10;
+    double e = params[2] * 4.0;
+
+    double n = conic_mean_motion(mu, p, e);
+    double maxM = conic_closed(e) ?
+        M_PI : anomaly_eccentric_to_mean(e, M_PI);
+    double t = (-1.0 + 2.0 * params[3]) * maxM / n;
+
+    struct orbit orbit;
+    orbit_from_elements(&orbit, mu, p, e, 0.0, 0.0, 0.0, 0.0);
+
+    vec4d pos, vel;
+    orbit_state_time(&orbit, (double*)&pos, (double*)&vel, t);
+
+    float posf[4], velf[4];
+    orbit_state_time_f(&orbit, posf, velf, t);
+
+    // float e: relative error of 1 - e is FLT_EPSILON/|1 - e|
+    double scale = conic_parabolic(e) ? 1.0 : fmin(1.0, fabs(1.0 - e));
+    double tol = 16.0 * FLT_EPSILON / scale;
+
+    double pos_err = 0.0, vel_err = 0.0;
+    for(int i = 0; i < 4; ++i) {
+        ASSERT(isfinite(posf[i]) && isfinite(velf[i]),
+            "Float state not NaN");
+        pos_err = fmax(pos_err, fabs(posf[i] - pos[i]));
+        vel_err = fmax(vel_err, fabs(velf[i] - vel[i]));
+    }
+
+    ASSERT(pos_err <= tol * mag(pos), "Double and float position");
+    ASSERT(vel_err <= tol * mag(vel), "Double and float velocity");
+}
+
+void orbit_batch_test(
+    double *params,
+    int num_params,
+    void *extra_args,
+    struct numtest_ctx *test_ctx) {
+    (void)extra_args;
+    ASSERT(num_params == 5, "");
+
+    double mu = 1.0 + params[0] * 1.0e10;
+    double p = 1.0 + params[1] * 1.0e10;
+    double inc = (-1.0 + 2.0 * params[3]) * M_PI;
+
+    // circular equatorial, circular, radial (x and z), equatorial,
+    // any conic and a scalar remainder
+    const int n = 11;
+    double x[n], y[n], z[n], vx[n], vy[n], vz[n], epoch[n];
+    vec4d pos[n], vel[n];
+
+    for(int i = 0; i < n; ++i) {
+        epoch[i] = (-1.0 + 2.0 * params[4]) * 1.0e3 + i;
+
+        if(i == 2 || i == 3) {
+            double r = 1.0 + params[1] * 1.0e5;
+            double v = (0.5 + params[2]) * sqrt(2.0 * mu/r);
+            vec4d axis = i == 2 ?
+                (vec4d){ 1.0, 0.0, 0.0, 0.0 } :
+                (vec4d){ 0.0, 0.0, -1.0, 0.0 };
+            pos[i] = splat4d(r) * axis;
+            vel[i] = splat4d(v) * axis;
+        } else {
+            double e = i < 2 ? 0.0 : params[2] * 4.0 * (i - 3) / 7.0;
+            double maxf = anomaly_eccentric_to_true(e, M_PI);
+            double f = (-1.0 + 2.0 * fmod(params[4] + i / (double)n, 1.0)) *
+                0.9 * maxf;
+
+            // not through orbit_from_elements, its e = 0 comes back as 1e-8
+            double i_n = i == 0 || i == 4 ? 0.0 : inc;
+            vec4d major = orientation_major_axis(i_n, i * 0.5, i * -0.25);
+            vec4d minor = orientation_minor_axis(i_n, i * 0.5, i * -0.25);
+            vec4d radial = splat4d(cos(f)) * major + splat4d(sin(f)) * minor;
+            vec4d horizontal = -splat4d(sin(f)) * major + splat4d(cos(f)) * minor;
+
+            pos[i] = splat4d(true_radius(p, e, f)) * radial;
+            vel[i] = splat4d(true_velocity_radial(mu, p, e, f)) * radial +
+                splat4d(true_velocity_horizontal(mu, p, e, f)) * horizontal;
+        }
+
+        x[i] = pos[i][0]; y[i] = pos[i][1]; z[i] = pos[i][2];
+        vx[i] = vel[i][0]; vy[i] = vel[i][1]; vz[i] = vel[i][2];
+    }
+
+    struct orbit orbits[n];
+    orbit_from_state_n(orbits, mu, x, y, z, vx, vy, vz, epoch, n);
+
+    for(int i = 0; i < n; ++i) {
+        struct orbit orbit;
+        orbit_from_state(&orbit, mu, pos[i], vel[i], epoch[i]);
+        const struct orbit *batch = orbits + i;
+
+        ASSERT(orbit_radial(batch) == (i == 2 || i == 3),
+            "Batch orbit is radial (batch %d)", i);
+        // the same kernel as orbit_from_state, bit for bit
+        ASSERT(batch->type == orbit.type,
+            "Batch conic type (batch %d)", i);
+        ASSERT(batch->orbital_energy == orbit.orbital_energy,
+            "Batch specific orbital energy (batch %d)", i);
+        ASSERT(batch->angular_momentum == orbit.angular_momentum,
+            "Batch angular momentum (batch %d)", i);
+        ASSERT(batch->semi_latus_rectum == orbit.semi_latus_rectum,
+            "Batch semi latus rectum (batch %d)", i);
+        ASSERT(batch->eccentricity == orbit.eccentricity,
+            "Batch eccentricity (batch %d)", i);
+        ASSERT(batch->periapsis_time == orbit.periapsis_time ||
+            (isnan(batch->periapsis_time) && isnan(orbit.periapsis_time)),
+            "Batch periapsis time (batch %d)", i);
+        ASSERT(all4l(batch->major_axis == orbit.major_axis) &&
+            all4l(batch->minor_axis == orbit.minor_axis) &&
+            all4l(batch->normal_axis == orbit.normal_axis),
+            "Batch orbit orientation (batch %d)", i);
+    }
+}
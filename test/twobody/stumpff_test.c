@@ -147,6 +147,19 @@ void stumpff_test(
         ASSERT_EQF(cs[i], cs_fast[i],
             "Stumpff fast series and series c%d are equal", i);
 
+    // fast series with derivatives
+    double cs_fast_d[4], dcs_fast_d[4];
+    stumpff_fast_with_derivatives(z, cs_fast_d, dcs_fast_d);
+
+    for(int i = 0; i < 4; ++i) {
+        ASSERT(isfinite(cs_fast_d[i]) && isfinite(dcs_fast_d[i]),
+            "Stumpff fast series with derivatives c%d not NaN", i);
+        ASSERT_EQF(cs_fast[i], cs_fast_d[i],
+            "Stumpff fast series with and without derivatives c%d are equal", i);
+        ASSERT_EQF(cs_dz_s[i], dcs_fast_d[i],
+            "Stumpff fast derivative and derivative series c%d are equal", i);
+    }
+
     double cs_four[4];
     stumpff_fast(4.0 * z, cs_four);
 
@@ -159,4 +172,20 @@ void stumpff_test(
         "c_2(4z) = c_1(z)^2 / 2");
     ASSERT_EQF(cs_four[3], (cs[2] + cs[0]*cs[3])/4.0,
         "c_3(4z) = (c_2(z) + c_0(z)*c_3(z))/4");
+
+    // batch, lanes with different reduction counts and a remainder
+    const int n = 7;
+    double zs[n], cs_batch[4*n];
+    for(int i = 0; i < n; ++i)
+        zs[i] = ldexp(i % 2 ? -z : z, 2*(i - 3));
+    stumpff_fast_n(zs, cs_batch, n);
+
+    for(int i = 0; i < n; ++i) {
+        double cs_scalar[4];
+        stumpff_fast(zs[i], cs_scalar);
+
+        for(int k = 0; k < 4; ++k)
+            ASSERT_EQF(cs_batch[4*i + k], cs_scalar[k],
+                "Stumpff fast series batch and scalar c%d (batch %d)", k, i);
+    }
 }
@@ -0,0 +1,129 @@
+#include <twobody/twobody.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../numtest.h"
+
+static int autotune_cache(
+    const char *cache_path,
+    unsigned long long *hash, int *solver) {
+    // 1 if the file holds a cache line of this version
+    FILE *file = fopen(cache_path, "r");
+    if(!file)
+        return 0;
+
+    char version[32];
+    int ok = fscanf(file, "twobody %31s %llx %d", version, hash, solver) == 3 &&
+        strcmp(version, twobody_version()) == 0;
+    fclose(file);
+    return ok;
+}
+
+static void autotune_cache_write(const char *cache_path, const char *line) {
+    FILE *file = fopen(cache_path, "w");
+    if(file) {
+        fputs(line, file);
+        fclose(file);
+    }
+}
+
+void twobody_autotune_test(
+    double *params,
+    int num_params,
+    void *extra_args,
+    struct numtest_ctx *test_ctx) {
+    (void)extra_args;
+    ASSERT(num_params == 2, "");
+
+    enum { n = 8 };
+    double e[n], M[n];
+    for(int i = 0; i < n; ++i) {
+        double u = fmod(params[0] + i / (double)n, 1.0);
+        double v = fmod(params[1] + i * 0.382, 1.0);
+        e[i] = 0.99 * u;
+        M[i] = M_PI * (-1.0 + 2.0 * v);
+    }
+
+    char cache_path[] = "/tmp/twobody_autotune_XXXXXX";
+    int fd = mkstemp(cache_path);
+    ASSERT(fd >= 0, "Temporary cache file");
+    if(fd < 0)
+        return;
+    close(fd);
+    remove(cache_path);
+
+    enum anomaly_solver solver = anomaly_get_solver();
+
+    // no cache: tune and write
+    enum anomaly_solver tuned = twobody_autotune(e, M, n, cache_path);
+    ASSERT(tuned >= ANOMALY_SOLVER_LAGUERRE_CONWAY && tuned <= ANOMALY_SOLVER_FIXED,
+        "Tuned solver");
+    ASSERT(anomaly_get_solver() == tuned, "Tuned solver installed");
+
+    for(int i = 0; i < n; ++i) {
+        double E = anomaly_mean_to_eccentric(e[i], M[i]), E_n;
+        anomaly_mean_to_eccentric_n(e + i, M + i, &E_n, 1);
+
+        anomaly_set_solver(ANOMALY_SOLVER_LAGUERRE_CONWAY);
+        double Eref = anomaly_mean_to_eccentric(e[i], M[i]);
+        anomaly_set_solver(tuned);
+
+        ASSERT(fabs(E - Eref) <= 1.0e-12 * fmax(1.0, fabs(Eref)) &&
+            fabs(E_n - Eref) <= 1.0e-12 * fmax(1.0, fabs(Eref)),
+            "Tuned solver accurate, scalar and batch (e = %g, M = %g)", e[i], M[i]);
+    }
+
+    unsigned long long hash = 0;
+    int cached = -1;
+    ASSERT(autotune_cache(cache_path, &hash, &cached) && cached == (int)tuned,
+        "Cache written");
+
+    // cache hit: another solver in the file is taken without timing
+    enum anomaly_solver other = (tuned + 1) % (ANOMALY_SOLVER_FIXED + 1);
+    char line[128];
+    snprintf(line, sizeof(line), "twobody %s %llx %d\n",
+        twobody_version(), hash, (int)other);
+    autotune_cache_write(cache_path, line);
+
+    ASSERT(twobody_autotune(e, M, n, cache_path) == other, "Cache read");
+    ASSERT(anomaly_get_solver() == other, "Cached solver installed");
+
+    // other samples, other hash: tune again and overwrite
+    double M_other[n];
+    memcpy(M_other, M, sizeof(M));
+    M_other[0] = -M_other[0] + 0.5;
+
+    unsigned long long hash_other = hash;
+    tuned = twobody_autotune(e, M_other, n, cache_path);
+    ASSERT(autotune_cache(cache_path, &hash_other, &cached) &&
+        hash_other != hash && cached == (int)tuned,
+        "Hash mismatch tunes again");
+
+    // unreadable, other version or out of range solver: tune again
+    const char *invalid[] = {
+        "garbage\n",
+        "twobody 0.0.0-other 0 0\n",
+        "twobody %s %llx 99\n" };
+    for(int i = 0; i < 3; ++i) {
+        snprintf(line, sizeof(line), invalid[i], twobody_version(), hash);
+        autotune_cache_write(cache_path, line);
+
+        tuned = twobody_autotune(e, M, n, cache_path);
+        ASSERT(autotune_cache(cache_path, &hash_other, &cached) &&
+            hash_other == hash && cached == (int)tuned,
+            "Invalid cache file (%d) tunes again", i);
+    }
+
+    // no cache file or none writable: tune every time
+    remove(cache_path);
+    tuned = twobody_autotune(e, M, n, 0);
+    ASSERT(anomaly_get_solver() == tuned, "No cache path");
+    tuned = twobody_autotune(e, M, n, "/nonexistent/twobody_autotune");
+    ASSERT(anomaly_get_solver() == tuned, "Cache not writable");
+
+    anomaly_set_solver(solver);
+}
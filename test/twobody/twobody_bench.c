@@ -0,0 +1,946 @@
+#include <twobody/twobody.h>
+#include <twobody/math_utils.h>
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+struct bench_case {
+    const char *name;
+    void (*func)();
+};
+
+static volatile double bench_sink; // keep results alive
+
+static double bench_clock() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BENCH_CYCLES_UNIT "cycles"
+static unsigned long long bench_cycles() {
+    _mm_lfence(); // no reordering around the time stamp
+    unsigned long long t = __rdtsc();
+    _mm_lfence();
+    return t;
+}
+#else
+#define BENCH_CYCLES_UNIT "ns"
+static unsigned long long bench_cycles() {
+    return (unsigned long long)(bench_clock() * 1.0e9);
+}
+#endif
+
+static int bench_compare_ull(const void *a, const void *b) {
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+    return x < y ? -1 : (x > y);
+}
+
+typedef double (bench_iterate_func)(double e, double M, double E0, int max_steps);
+
+// number of steps until the result no longer changes
+static int bench_steps(bench_iterate_func *iterate, double e, double M, double E0) {
+    double E = iterate(e, M, E0, 0);
+
+    int steps = 1;
+    while(steps < 20 && iterate(e, M, E0, steps) != E)
+        ++steps;
+
+    return steps;
+}
+
+static double bench_hyperbolic_guess_log(double e, double M) {
+    return sign(M) * log(2.0 * fabs(M) / e + 1.85);
+}
+
+static void bench_hyperbolic() {
+    const double es[] = { 1.0001, 1.01, 1.1, 1.5, 2.0, 5.0, 20.0 };
+    const int num_es = sizeof(es)/sizeof(*es);
+    enum { num_M = 1201 }; // log10 M = -6..6
+
+    printf("%-10s %10s %10s %10s %10s %10s %10s\n",
+        "e", "log avg", "log max", "new avg", "new max",
+        "log ns", "new ns");
+
+    for(int i = 0; i < num_es; ++i) {
+        double e = es[i];
+        double M[num_M];
+        for(int j = 0; j < num_M; ++j)
+            M[j] = pow(10.0, -6.0 + 12.0 * j / (num_M - 1));
+
+        int sum_old = 0, max_old = 0, sum_new = 0, max_new = 0;
+        for(int j = 0; j < num_M; ++j) {
+            int old = bench_steps(anomaly_eccentric_iterate,
+                e, M[j], bench_hyperbolic_guess_log(e, M[j]));
+            int new = bench_steps(anomaly_hyperbolic_iterate,
+                e, M[j], anomaly_hyperbolic_guess(e, M[j]));
+
+            sum_old += old; max_old = old > max_old ? old : max_old;
+            sum_new += new; max_new = new > max_new ? new : max_new;
+        }
+
+        const int repeat = 200;
+        double sum = 0.0;
+
+        double t0 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            for(int j = 0; j < num_M; ++j)
+                sum += anomaly_eccentric_iterate(
+                    e, M[j], bench_hyperbolic_guess_log(e, M[j]), 0);
+        double t1 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            for(int j = 0; j < num_M; ++j)
+                sum += anomaly_mean_to_eccentric(e, M[j]);
+        double t2 = bench_clock();
+
+        bench_sink = sum;
+
+        double scale = 1.0e9 / (repeat * num_M);
+        printf("%-10g %10.2f %10d %10.2f %10d %10.1f %10.1f\n",
+            e,
+            sum_old / (double)num_M, max_old,
+            sum_new / (double)num_M, max_new,
+            (t1 - t0) * scale, (t2 - t1) * scale);
+    }
+
+    // batch solver, |M| < 1e3 keeps all lanes in the vector kernel
+    enum { num_batch = 4096 };
+    static double e[num_batch], M[num_batch], E[num_batch];
+    for(int j = 0; j < num_batch; ++j) {
+        e[j] = 1.0001 + 4.0 * (j % 97) / 97.0;
+        M[j] = pow(10.0, -6.0 + 9.0 * (j % 101) / 101.0);
+    }
+
+    const int repeat = 100;
+    double t0 = bench_clock();
+    for(int r = 0; r < repeat; ++r)
+        for(int j = 0; j < num_batch; ++j)
+            E[j] = anomaly_mean_to_eccentric(e[j], M[j]);
+    double t1 = bench_clock();
+    for(int r = 0; r < repeat; ++r)
+        anomaly_mean_to_eccentric_n(e, M, E, num_batch);
+    double t2 = bench_clock();
+    bench_sink = E[0];
+
+    double scale = 1.0e9 / (repeat * num_batch);
+    printf("scalar %.1f ns, batch %.1f ns per hyperbolic anomaly\n",
+        (t1 - t0) * scale, (t2 - t1) * scale);
+}
+
+static void bench_fixed() {
+    const double ranges[][2] = {
+        { 0.0, 0.01 }, { 0.01, 0.8 }, { 0.8, 0.9 }, { 0.9, 0.99 },
+        { 0.99, 1.0 }, { 1.0001, 1.01 }, { 1.01, 10.0 },
+    };
+    const int num_ranges = sizeof(ranges)/sizeof(*ranges);
+    enum { num_samples = 100000 };
+    static unsigned long long cycles[num_samples];
+
+    // cost of reading the time stamp, subtracted from each sample
+    unsigned long long overhead = ~0ull;
+    for(int j = 0; j < 1000; ++j) {
+        unsigned long long t0 = bench_cycles();
+        unsigned long long t1 = bench_cycles();
+        if(t1 - t0 < overhead)
+            overhead = t1 - t0;
+    }
+
+    printf("%-18s %-8s %10s %10s %10s  (" BENCH_CYCLES_UNIT ")\n",
+        "e", "solver", "median", "99.9%", "max");
+
+    enum anomaly_solver solver = anomaly_get_solver();
+    const enum anomaly_solver solvers[] = {
+        ANOMALY_SOLVER_LAGUERRE_CONWAY, ANOMALY_SOLVER_FIXED
+    };
+    const char *solver_names[] = { "default", "fixed" };
+
+    for(int i = 0; i < num_ranges; ++i) {
+        for(int k = 0; k < 2; ++k) {
+            anomaly_set_solver(solvers[k]);
+
+            double sum = 0.0;
+            for(int j = 0; j < num_samples; ++j) {
+                double u = (j % 317) / 317.0, v = (j % 331) / 331.0;
+                double e = ranges[i][0] + (ranges[i][1] - ranges[i][0]) * u;
+                double M = e < 1.0 ?
+                    M_PI * (-1.0 + 2.0 * v) :
+                    pow(10.0, -6.0 + 9.0 * v); // hyperbolic |M| < 1e3
+
+                // best of a few runs, interrupts and cache misses are not
+                // data dependent and would hide the worst input
+                cycles[j] = ~0ull;
+                for(int r = 0; r < 5; ++r) {
+                    unsigned long long t0 = bench_cycles();
+                    sum += anomaly_mean_to_eccentric(e, M);
+                    unsigned long long t1 = bench_cycles();
+
+                    unsigned long long c = t1 - t0 > overhead ? t1 - t0 - overhead : 0;
+                    if(c < cycles[j])
+                        cycles[j] = c;
+                }
+            }
+            bench_sink = sum;
+
+            qsort(cycles, num_samples, sizeof(*cycles), bench_compare_ull);
+            printf("%8g..%-8g %-8s %10llu %10llu %10llu\n",
+                ranges[i][0], ranges[i][1], solver_names[k],
+                cycles[num_samples / 2],
+                cycles[num_samples - num_samples / 1000],
+                cycles[num_samples - 1]);
+        }
+    }
+
+    anomaly_set_solver(solver);
+}
+
+static void bench_float() {
+    enum { num_batch = 4096 };
+    static double e[num_batch], M[num_batch], E[num_batch], Emixed[num_batch];
+    static float ef[num_batch], Mf[num_batch], Ef[num_batch];
+
+    const double ranges[][2] = { { 0.01, 0.5 }, { 0.5, 0.9 }, { 0.9, 0.99 } };
+    const int num_ranges = sizeof(ranges)/sizeof(*ranges);
+
+    printf("%-18s %10s %10s %10s %10s %10s  (ns, rad)\n",
+        "e", "double", "float", "mixed", "float err", "mixed err");
+
+    for(int i = 0; i < num_ranges; ++i) {
+        for(int j = 0; j < num_batch; ++j) {
+            double u = (j % 97) / 97.0, v = (j % 101) / 101.0;
+            e[j] = ranges[i][0] + (ranges[i][1] - ranges[i][0]) * u;
+            M[j] = M_PI * (-1.0 + 2.0 * v);
+            ef[j] = e[j];
+            Mf[j] = M[j];
+        }
+
+        const int repeat = 100;
+        double t0 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            anomaly_mean_to_eccentric_n(e, M, E, num_batch);
+        double t1 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            anomaly_mean_to_eccentric_nf(ef, Mf, Ef, num_batch);
+        double t2 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            anomaly_mean_to_eccentric_mixed_n(e, M, Emixed, num_batch);
+        double t3 = bench_clock();
+
+        // float error against the double solution of the rounded inputs
+        double err_float = 0.0, err_mixed = 0.0;
+        for(int j = 0; j < num_batch; ++j) {
+            double Eref = anomaly_mean_to_eccentric(ef[j], Mf[j]);
+            err_float = fmax(err_float, fabs(Ef[j] - Eref));
+            err_mixed = fmax(err_mixed, fabs(Emixed[j] - E[j]));
+        }
+        bench_sink = E[0] + Ef[0] + Emixed[0];
+
+        double scale = 1.0e9 / (repeat * num_batch);
+        printf("%8g..%-8g %10.1f %10.1f %10.1f %10.1e %10.1e\n",
+            ranges[i][0], ranges[i][1],
+            (t1 - t0) * scale, (t2 - t1) * scale, (t3 - t2) * scale,
+            err_float, err_mixed);
+    }
+}
+
+static double bench_eccentric_tol;
+
+static double bench_eccentric_iterate_tol(double e, double M, double E0, int max_steps) {
+    return anomaly_eccentric_iterate_tol(e, M, E0, max_steps, bench_eccentric_tol);
+}
+
+static void bench_tol() {
+    const double tols[] = { DBL_EPSILON, 1.0e-12, 1.0e-8, 1.0e-6, 1.0e-4 };
+    const int num_tols = sizeof(tols)/sizeof(*tols);
+
+    enum { num_batch = 4096 };
+    static double e[num_batch], M[num_batch], E[num_batch], Eref[num_batch];
+    for(int j = 0; j < num_batch; ++j) {
+        e[j] = 0.01 + 0.98 * (j % 97) / 97.0;
+        M[j] = M_PI * (-1.0 + 2.0 * (j % 101) / 101.0);
+    }
+    anomaly_mean_to_eccentric_n(e, M, Eref, num_batch);
+
+    printf("%-10s %10s %10s %10s %10s %10s %10s\n",
+        "tol", "avg steps", "max steps", "scalar ns", "batch ns", "max err",
+        "s ns");
+
+    for(int k = 0; k < num_tols; ++k) {
+        double tol = tols[k];
+
+        int sum_steps = 0, max_steps = 0;
+        bench_eccentric_tol = tol;
+        for(int j = 0; j < num_batch; ++j) {
+            double E0 = e[j] > 0.9 ? M[j] + 0.85 * e[j] * sign(M[j]) : M[j];
+            int steps = bench_steps(bench_eccentric_iterate_tol, e[j], M[j], E0);
+            sum_steps += steps;
+            max_steps = steps > max_steps ? steps : max_steps;
+        }
+
+        const int repeat = 100;
+        double sum = 0.0;
+        double t0 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            for(int j = 0; j < num_batch; ++j)
+                sum += anomaly_mean_to_eccentric_tol(e[j], M[j], tol);
+        double t1 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            anomaly_mean_to_eccentric_n_tol(e, M, E, num_batch, tol);
+        double t2 = bench_clock();
+
+        // universal variable, elliptic and hyperbolic arcs
+        for(int r = 0; r < repeat; ++r) {
+            for(int j = 0; j < num_batch; ++j) {
+                double alpha = -1.0 + 2.0 * (j % 97) / 97.0;
+                double time = 0.1 + 10.0 * (j % 101) / 101.0;
+                double s0 = universal_guess_s(1.0, alpha, 1.0, 0.2, time);
+                sum += universal_iterate_s_tol(1.0, alpha, 1.0, 0.2, s0, time, 0, tol);
+            }
+        }
+        double t3 = bench_clock();
+
+        double err = 0.0;
+        for(int j = 0; j < num_batch; ++j)
+            err = fmax(err, fabs(E[j] - Eref[j]));
+        bench_sink = sum + E[0];
+
+        double scale = 1.0e9 / (repeat * num_batch);
+        printf("%-10.3g %10.2f %10d %10.1f %10.1f %10.1e %10.1f\n",
+            tol, sum_steps / (double)num_batch, max_steps,
+            (t1 - t0) * scale, (t2 - t1) * scale, err, (t3 - t2) * scale);
+    }
+}
+
+static void bench_autotune() {
+    const char *cache_path = "twobody_bench_autotune.tmp";
+    const char *solver_names[] = { "laguerre-conway", "markley", "fixed" };
+
+    enum anomaly_solver solver = anomaly_get_solver();
+    remove(cache_path);
+
+    double t0 = bench_clock();
+    enum anomaly_solver tuned = twobody_autotune(0, 0, 0, cache_path);
+    double t1 = bench_clock();
+    enum anomaly_solver cached = twobody_autotune(0, 0, 0, cache_path);
+    double t2 = bench_clock();
+
+    printf("tuned: %s (%.1f ms), cached: %s (%.3f ms)\n",
+        solver_names[tuned], (t1 - t0) * 1.0e3,
+        solver_names[cached], (t2 - t1) * 1.0e3);
+
+    remove(cache_path);
+    anomaly_set_solver(solver);
+}
+
+static void bench_stumpff_series(double z, double *cs) {
+    // stumpff_fast before the table: reduce to z*z < 0.1, sum the series
+    int n = 0;
+    for(n = 0; z*z >= 0.1; ++n)
+        z = z / 4;
+
+    double c2 = stumpff_series(2, z);
+    double c3 = stumpff_series(3, z);
+    double c1 = 1.0 - z*c3;
+    double c0 = 1.0 - z*c2;
+
+    while(n--) {
+        c3 = (c2 + c0*c3) / 4.0;
+        c2 = c1*c1 / 2.0;
+        c1 = c0*c1;
+        c0 = 2.0 * c0*c0 - 1.0;
+    }
+
+    cs[0] = c0; cs[1] = c1; cs[2] = c2; cs[3] = c3;
+}
+
+static long double bench_stumpff_reference(int k, long double z) {
+    // c_k(z) = sum (-z)^i / (k + 2i)!, long double, the terms cancel for
+    // larger |z|: c0 and c1 in closed form and c_k+2 = (1/k! - c_k) / z
+    if(fabsl(z) > 16.0L) {
+        long double w = sqrtl(fabsl(z));
+        long double c[6] = {
+            z > 0.0L ? cosl(w) : coshl(w),
+            z > 0.0L ? sinl(w) / w : sinhl(w) / w };
+        long double fac = 1.0L; // (i - 2)!
+        for(int i = 2; i <= k; ++i) {
+            fac = i > 3 ? fac * (i - 2) : 1.0L;
+            c[i] = (1.0L / fac - c[i-2]) / z;
+        }
+        return c[k];
+    }
+
+    long double c = 1.0L;
+    for(int i = 2; i <= k; ++i)
+        c = c / i;
+
+    long double sum = c;
+    for(int i = 1; i < 100; ++i) {
+        c = c * -z / ((long double)(k + 2*i) * (k + 2*i - 1));
+        sum += c;
+    }
+
+    return sum;
+}
+
+static void bench_stumpff() {
+    enum { num_batch = 4096 };
+    static double z[num_batch], cs[4 * num_batch];
+
+    const double ranges[][2] = {
+        { -0.25, 0.25 }, { -16.0, 16.0 }, { -40.0, 40.0 }, { -64.0, 64.0 },
+        { -1.0e4, 1.0e4 } };
+    const int num_ranges = sizeof(ranges)/sizeof(*ranges);
+
+    printf("%-18s %10s %10s %10s %10s %10s  (ns, ulp of c2 and c3)\n",
+        "z", "series", "table", "batch", "series err", "table err");
+
+    for(int i = 0; i < num_ranges; ++i) {
+        for(int j = 0; j < num_batch; ++j)
+            z[j] = ranges[i][0] + (ranges[i][1] - ranges[i][0]) * (j % 101) / 100.0;
+
+        const int repeat = 100;
+        double t0 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            for(int j = 0; j < num_batch; ++j)
+                bench_stumpff_series(z[j], cs + 4*j);
+        double t1 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            for(int j = 0; j < num_batch; ++j)
+                stumpff_fast(z[j], cs + 4*j);
+        double t2 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            stumpff_fast_n(z, cs, num_batch);
+        double t3 = bench_clock();
+        bench_sink = cs[0];
+
+        double err_series = 0.0, err_table = 0.0;
+        for(int j = 0; j < num_batch; ++j) {
+            double cs_series[4], cs_table[4];
+            bench_stumpff_series(z[j], cs_series);
+            stumpff_fast(z[j], cs_table);
+
+            for(int k = 2; k < 4; ++k) {
+                long double c = bench_stumpff_reference(k, z[j]);
+                err_series = fmax(err_series,
+                    fabsl((cs_series[k] - c) / c) / DBL_EPSILON);
+                err_table = fmax(err_table,
+                    fabsl((cs_table[k] - c) / c) / DBL_EPSILON);
+            }
+        }
+
+        double scale = 1.0e9 / (repeat * num_batch);
+        printf("%8g..%-8g %10.1f %10.1f %10.1f",
+            ranges[i][0], ranges[i][1],
+            (t1 - t0) * scale, (t2 - t1) * scale, (t3 - t2) * scale);
+        printf(" %10.1f %10.1f\n", err_series, err_table);
+    }
+}
+
+static void bench_stumpff_derivatives() {
+    enum { num_batch = 4096 };
+    static double z[num_batch], cs[4 * num_batch], dcs[4 * num_batch];
+
+    const double ranges[][2] = { { -0.25, 0.25 }, { -16.0, 16.0 }, { -40.0, 40.0 } };
+    const int num_ranges = sizeof(ranges)/sizeof(*ranges);
+
+    printf("%-18s %10s %10s %10s %10s %10s  (ns, ulp of dc0..dc3)\n",
+        "z", "values", "separate", "fused", "sep err", "fused err");
+
+    for(int i = 0; i < num_ranges; ++i) {
+        for(int j = 0; j < num_batch; ++j)
+            z[j] = ranges[i][0] + (ranges[i][1] - ranges[i][0]) * (j % 101) / 100.0;
+
+        const int repeat = 100;
+        double t0 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            for(int j = 0; j < num_batch; ++j)
+                stumpff_fast(z[j], cs + 4*j);
+        double t1 = bench_clock();
+        for(int r = 0; r < repeat; ++r) {
+            for(int j = 0; j < num_batch; ++j) {
+                stumpff_fast(z[j], cs + 4*j);
+                dcs[4*j + 0] = stumpff_dc0dz(z[j]);
+                dcs[4*j + 1] = stumpff_dc1dz(z[j]);
+                dcs[4*j + 2] = stumpff_dc2dz(z[j]);
+                dcs[4*j + 3] = stumpff_dc3dz(z[j]);
+            }
+        }
+        double t2 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            for(int j = 0; j < num_batch; ++j)
+                stumpff_fast_with_derivatives(z[j], cs + 4*j, dcs + 4*j);
+        double t3 = bench_clock();
+        bench_sink = cs[0] + dcs[0];
+
+        // 2 dc_k/dz = k*c_k+2 - c_k+1
+        double err_separate = 0.0, err_fused = 0.0;
+        for(int j = 0; j < num_batch; ++j) {
+            double dcs_separate[4] = {
+                stumpff_dc0dz(z[j]), stumpff_dc1dz(z[j]),
+                stumpff_dc2dz(z[j]), stumpff_dc3dz(z[j]) };
+
+            for(int k = 0; k < 4; ++k) {
+                long double dc = 0.5L * (k * bench_stumpff_reference(k + 2, z[j]) -
+                    bench_stumpff_reference(k + 1, z[j]));
+                err_separate = fmax(err_separate,
+                    fabsl((dcs_separate[k] - dc) / dc) / DBL_EPSILON);
+                err_fused = fmax(err_fused,
+                    fabsl((dcs[4*j + k] - dc) / dc) / DBL_EPSILON);
+            }
+        }
+
+        double scale = 1.0e9 / (repeat * num_batch);
+        printf("%8g..%-8g %10.1f %10.1f %10.1f %10.3g %10.3g\n",
+            ranges[i][0], ranges[i][1],
+            (t1 - t0) * scale, (t2 - t1) * scale, (t3 - t2) * scale,
+            err_separate, err_fused);
+    }
+}
+
+static void bench_universal_propagate() {
+    enum { num_batch = 4096 };
+    static double x[num_batch], y[num_batch], z[num_batch];
+    static double vx[num_batch], vy[num_batch], vz[num_batch], dt[num_batch];
+    static double pos[num_batch][3], vel[num_batch][3];
+
+    const double ranges[][2] = { { 0.0, 0.9 }, { 1.1, 5.0 }, { 0.0, 3.0 } };
+    const int num_ranges = sizeof(ranges)/sizeof(*ranges);
+    const double mu = 1.0, p = 1.0;
+
+    printf("%-18s %10s %10s %10s  (ns per state)\n",
+        "e", "scalar", "batch", "speedup");
+
+    for(int i = 0; i < num_ranges; ++i) {
+        for(int j = 0; j < num_batch; ++j) {
+            double e = ranges[i][0] + (ranges[i][1] - ranges[i][0]) * (j % 97) / 96.0;
+            double E = (-1.0 + (j % 89) / 44.0) * (e < 1.0 ? M_PI : 1.0);
+            double ci = cos(j * 0.1), si = sin(j * 0.1);
+
+            pos[j][0] = eccentric_x(p, e, E);
+            pos[j][1] = ci * eccentric_y(p, e, E);
+            pos[j][2] = si * eccentric_y(p, e, E);
+            vel[j][0] = eccentric_xdot(mu, p, e, E);
+            vel[j][1] = ci * eccentric_ydot(mu, p, e, E);
+            vel[j][2] = si * eccentric_ydot(mu, p, e, E);
+            dt[j] = (-1.0 + (j % 83) / 41.0) * 2.0*M_PI;
+        }
+
+        const int repeat = 20;
+        double t_scalar = 0.0, t_batch = 0.0;
+        for(int r = 0; r < repeat; ++r) {
+            double t0 = bench_clock();
+            for(int j = 0; j < num_batch; ++j) {
+                double pos_out[3], vel_out[3];
+                universal_propagate(mu, pos[j], vel[j], dt[j], pos_out, vel_out);
+                bench_sink = pos_out[0] + vel_out[0];
+            }
+            double t1 = bench_clock();
+
+            for(int j = 0; j < num_batch; ++j) {
+                x[j] = pos[j][0]; y[j] = pos[j][1]; z[j] = pos[j][2];
+                vx[j] = vel[j][0]; vy[j] = vel[j][1]; vz[j] = vel[j][2];
+            }
+
+            double t2 = bench_clock();
+            universal_propagate_n(mu, x, y, z, vx, vy, vz, dt, num_batch);
+            double t3 = bench_clock();
+            bench_sink = x[0] + vx[0];
+
+            t_scalar += t1 - t0;
+            t_batch += t3 - t2;
+        }
+
+        double scale = 1.0e9 / (repeat * num_batch);
+        printf("%8g..%-8g %10.1f %10.1f %10.2f\n",
+            ranges[i][0], ranges[i][1],
+            t_scalar * scale, t_batch * scale, t_scalar / t_batch);
+    }
+}
+
+static double bench_universal_guess_linear(
+    double mu,
+    double alpha,
+    double r0, double sigma0,
+    double time) {
+    // universal_guess_s before the Kepler starters
+    double s = universal_guess_s(mu, 0.0, r0, sigma0, time); // parabolic
+
+    if(universal_parabolic(alpha) || fabs(alpha) * s*s < 1.0)
+        return s;
+
+    if(universal_hyperbolic(alpha))
+        return zero(time) ? 0.0 :
+            sign(time) * sqrt(1.0/-alpha) *
+            log(-2.0 * alpha * mu * time /
+                (sqrt(mu)*sigma0 +
+                     sign(time) * sqrt(mu/-alpha) * (1 - alpha*r0)));
+    else
+        return alpha*sqrt(mu) * time;
+}
+
+static void bench_universal_guess() {
+    enum { num_batch = 4096 };
+    static double alpha[num_batch], r0[num_batch], sigma0[num_batch], dt[num_batch];
+
+    // e range, time of flight in periods (elliptic) or 2*pi*sqrt(p^3/mu)
+    const double ranges[][3] = {
+        { 0.0, 0.5, 0.5 }, { 0.5, 0.99, 0.5 }, { 0.0, 0.99, 20.0 },
+        { 1.01, 5.0, 0.5 }, { 1.01, 5.0, 20.0 }, { 0.0, 3.0, 5.0 } };
+    const int num_ranges = sizeof(ranges)/sizeof(*ranges);
+    const double mu = 1.0, p = 1.0;
+
+    printf("%-20s %8s %6s %6s %8s  %s\n",
+        "e, time", "starter", "steps", "max", "ns", "histogram of steps 0..9, 10+");
+
+    for(int i = 0; i < num_ranges; ++i) {
+        int nan_states = 0;
+        for(int j = 0; j < num_batch; ++j) {
+            double e = ranges[i][0] + (ranges[i][1] - ranges[i][0]) * (j % 97) / 96.0;
+            double E = (-1.0 + (j % 89) / 44.0) * (e < 1.0 ? M_PI : 1.0);
+            double pos[3] = { eccentric_x(p, e, E), eccentric_y(p, e, E), 0.0 };
+            double vel[3] = {
+                eccentric_xdot(mu, p, e, E), eccentric_ydot(mu, p, e, E), 0.0 };
+
+            r0[j] = sqrt(pos[0]*pos[0] + pos[1]*pos[1]);
+            sigma0[j] = (pos[0]*vel[0] + pos[1]*vel[1]) / sqrt(mu);
+            alpha[j] = universal_alpha(mu, r0[j], vel[0]*vel[0] + vel[1]*vel[1]);
+
+            double period = e < 1.0 ?
+                universal_period(mu, alpha[j]) : 2.0*M_PI * sqrt(p*p*p/mu);
+            dt[j] = (-1.0 + (j % 83) / 41.0) * ranges[i][2] * period;
+        }
+
+        for(int g = 0; g < 2; ++g) {
+            unsigned long histogram[UNIVERSAL_MAX_STEPS + 1] = { 0 };
+            double s_sum = 0.0, best = INFINITY;
+
+            for(int r = 0; r < 10; ++r) { // best of 10
+                double t0 = bench_clock();
+                for(int j = 0; j < num_batch; ++j) {
+                    double s0 = g == 0 ?
+                        bench_universal_guess_linear(mu, alpha[j], r0[j], sigma0[j], dt[j]) :
+                        universal_guess_s(mu, alpha[j], r0[j], sigma0[j], dt[j]);
+                    s_sum += universal_iterate_s(
+                        mu, alpha[j], r0[j], sigma0[j], s0, dt[j], 0);
+                }
+                best = fmin(best, bench_clock() - t0);
+            }
+            bench_sink = s_sum;
+
+            // count steps apart from the timing
+            universal_set_histogram(histogram);
+            for(int j = 0; j < num_batch; ++j) {
+                double s0 = g == 0 ?
+                    bench_universal_guess_linear(mu, alpha[j], r0[j], sigma0[j], dt[j]) :
+                    universal_guess_s(mu, alpha[j], r0[j], sigma0[j], dt[j]);
+                double s = universal_iterate_s(
+                    mu, alpha[j], r0[j], sigma0[j], s0, dt[j], 0);
+                nan_states += g == 1 && !isfinite(s);
+            }
+            universal_set_histogram(0);
+
+            double mean = 0.0;
+            int max = 0;
+            for(int k = 0; k <= UNIVERSAL_MAX_STEPS; ++k) {
+                mean += k * histogram[k] / (double)num_batch;
+                max = histogram[k] ? k : max;
+            }
+
+            if(g == 0)
+                printf("%5g..%-5g %6g  ", ranges[i][0], ranges[i][1], ranges[i][2]);
+            else
+                printf("%-20s ", "");
+            printf("%8s %6.2f %6d %8.1f ", g == 0 ? "linear" : "kepler",
+                mean, max, best * 1.0e9 / num_batch);
+
+            unsigned long more = 0;
+            for(int k = 10; k <= UNIVERSAL_MAX_STEPS; ++k)
+                more += histogram[k];
+            for(int k = 0; k < 10; ++k)
+                printf(" %4lu", histogram[k]);
+            printf(" %4lu\n", more);
+        }
+
+        if(nan_states)
+            printf("%d NaN\n", nan_states);
+    }
+}
+
+static void bench_universal_fg() {
+    enum { num_batch = 4096 };
+    static double r0[num_batch], sigma0[num_batch], alpha[num_batch], s[num_batch];
+    static double out[6 * num_batch];
+
+    const double mu = 1.0;
+    for(int j = 0; j < num_batch; ++j) {
+        r0[j] = 0.5 + (j % 17) / 8.0;
+        sigma0[j] = -1.0 + (j % 13) / 6.0;
+        alpha[j] = -1.0 + (j % 11) / 5.0;
+        s[j] = -3.0 + (j % 19) / 3.0;
+    }
+
+    const int repeat = 100;
+    double t0 = bench_clock();
+    for(int r = 0; r < repeat; ++r) {
+        for(int j = 0; j < num_batch; ++j) {
+            double cs[4], *o = out + 6*j;
+            stumpff_fast(alpha[j] * s[j]*s[j], cs);
+            o[0] = universal_radius(r0[j], sigma0[j], s[j], cs);
+            o[1] = universal_sigma(alpha[j], r0[j], sigma0[j], s[j], cs);
+            o[2] = universal_f(mu, r0[j], s[j], cs);
+            o[3] = universal_g(mu, r0[j], sigma0[j], s[j], cs);
+            o[4] = universal_fdot(mu, r0[j], o[0], s[j], cs);
+            o[5] = universal_gdot(mu, o[0], s[j], cs);
+        }
+    }
+    double t1 = bench_clock();
+    for(int r = 0; r < repeat; ++r) {
+        for(int j = 0; j < num_batch; ++j) {
+            double cs[4];
+            stumpff_fast(alpha[j] * s[j]*s[j], cs);
+            universal_fg(mu, r0[j], sigma0[j], alpha[j], s[j], cs, out + 6*j);
+        }
+    }
+    double t2 = bench_clock();
+    for(int r = 0; r < repeat; ++r)
+        universal_fg_n(mu, r0, sigma0, alpha, s, out, num_batch);
+    double t3 = bench_clock();
+    bench_sink = out[0];
+
+    double scale = 1.0e9 / (repeat * num_batch);
+    printf("%10s %10s %10s  (ns, with Stumpff values)\n", "separate", "fused", "batch");
+    printf("%10.1f %10.1f %10.1f\n",
+        (t1 - t0) * scale, (t2 - t1) * scale, (t3 - t2) * scale);
+}
+
+static void bench_eccentric_state() {
+    enum { num_batch = 4096 };
+    static double e[num_batch], E[num_batch];
+    static double out[4 * num_batch];
+
+    const double mu = 1.0, p = 1.0;
+    for(int j = 0; j < num_batch; ++j) {
+        e[j] = (j % 3 == 2) ? 1.5 + (j % 7) / 4.0 : (j % 23) / 24.0;
+        E[j] = -3.0 + (j % 19) / 3.0;
+    }
+
+    struct orbit orbit;
+    orbit_from_elements(&orbit, mu, p, 0.5, 0.3, 0.2, 0.1, 0.0);
+
+    const int repeat = 100;
+    double t0 = bench_clock();
+    for(int r = 0; r < repeat; ++r) {
+        for(int j = 0; j < num_batch; ++j) {
+            double *o = out + 4*j;
+            o[0] = eccentric_x(p, e[j], E[j]);
+            o[1] = eccentric_y(p, e[j], E[j]);
+            o[2] = eccentric_xdot(mu, p, e[j], E[j]);
+            o[3] = eccentric_ydot(mu, p, e[j], E[j]);
+        }
+    }
+    double t1 = bench_clock();
+    for(int r = 0; r < repeat; ++r) {
+        for(int j = 0; j < num_batch; ++j) {
+            double *o = out + 4*j;
+            eccentric_state_2d(mu, p, e[j], E[j], o+0, o+1, o+2, o+3);
+        }
+    }
+    double t2 = bench_clock();
+    for(int r = 0; r < repeat; ++r) {
+        for(int j = 0; j < num_batch; j += 2) {
+            // 3d state of one orbit (cached p, e, a, b, n)
+            double *o = out + 4*j;
+            orbit_state_eccentric(&orbit, o, o + 4, E[j]);
+        }
+    }
+    double t3 = bench_clock();
+    bench_sink = out[0];
+
+    double scale = 1.0e9 / (repeat * num_batch);
+    printf("%10s %10s %10s  (ns per state)\n", "separate", "fused", "orbit");
+    printf("%10.1f %10.1f %10.1f\n",
+        (t1 - t0) * scale, (t2 - t1) * scale, (t3 - t2) * scale * 2.0);
+}
+
+static void bench_true_state() {
+    enum { num_batch = 4096 };
+    static double f[num_batch];
+    static double pos[4 * num_batch], vel[4 * num_batch];
+
+    const double mu = 1.0, p = 1.0, e = 0.5;
+    for(int j = 0; j < num_batch; ++j)
+        f[j] = -3.0 + 6.0 * j / num_batch;
+
+    struct orbit orbit;
+    orbit_from_elements(&orbit, mu, p, e, 0.3, 0.2, 0.1, 0.0);
+
+    const int repeat = 100;
+    double t0 = bench_clock();
+    for(int r = 0; r < repeat; ++r) {
+        for(int j = 0; j < num_batch; ++j) {
+            // 2d state of the orbital plane only
+            double *o = pos + 4*j;
+            o[0] = true_x(p, e, f[j]);
+            o[1] = true_y(p, e, f[j]);
+            o[2] = true_xdot(mu, p, e, f[j]);
+            o[3] = true_ydot(mu, p, e, f[j]);
+        }
+    }
+    double t1 = bench_clock();
+    for(int r = 0; r < repeat; ++r) {
+        for(int j = 0; j < num_batch; ++j) {
+            double *o = pos + 4*j;
+            true_state_2d(mu, p, e, f[j], o+0, o+1, o+2, o+3);
+        }
+    }
+    double t2 = bench_clock();
+    for(int r = 0; r < repeat; ++r)
+        for(int j = 0; j < num_batch; ++j)
+            orbit_state_true(&orbit, pos + 4*j, vel + 4*j, f[j]);
+    double t3 = bench_clock();
+    for(int r = 0; r < repeat; ++r)
+        orbit_state_true_n(&orbit, pos, vel, f, num_batch);
+    double t4 = bench_clock();
+    bench_sink = pos[0] + vel[0];
+
+    double scale = 1.0e9 / (repeat * num_batch);
+    printf("%10s %10s %10s %10s  (ns per state)\n",
+        "separate", "fused", "orbit", "batch");
+    printf("%10.1f %10.1f %10.1f %10.1f\n",
+        (t1 - t0) * scale, (t2 - t1) * scale,
+        (t3 - t2) * scale, (t4 - t3) * scale);
+}
+
+static void bench_anomaly_conversion() {
+    enum { num_batch = 4096 };
+    static double e[num_batch], x[num_batch], out[num_batch];
+
+    // catalog-like mix, mostly elliptic
+    for(int j = 0; j < num_batch; ++j) {
+        e[j] = (j % 8 == 7) ? 1.2 + (j % 5) / 2.0 : 0.02 + (j % 47) / 50.0;
+        x[j] = -3.0 + (j % 31) / 5.0;
+    }
+
+    const char *names[] = {
+        "eccentric_to_true", "true_to_eccentric", "true_to_mean", "mean_to_true" };
+    double (*scalar[])(double, double) = {
+        anomaly_eccentric_to_true, anomaly_true_to_eccentric,
+        anomaly_true_to_mean, anomaly_mean_to_true };
+    void (*batch[])(const double *, const double *, double *, size_t) = {
+        anomaly_eccentric_to_true_n, anomaly_true_to_eccentric_n,
+        anomaly_true_to_mean_n, anomaly_mean_to_true_n };
+
+    const int repeat = 100;
+    printf("%18s %10s %10s  (ns)\n", "", "scalar", "batch");
+    for(int k = 0; k < 4; ++k) {
+        double t0 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            for(int j = 0; j < num_batch; ++j)
+                out[j] = scalar[k](e[j], x[j]);
+        double t1 = bench_clock();
+        for(int r = 0; r < repeat; ++r)
+            batch[k](e, x, out, num_batch);
+        double t2 = bench_clock();
+        bench_sink = out[0];
+
+        double scale = 1.0e9 / (repeat * num_batch);
+        printf("%18s %10.1f %10.1f\n", names[k], (t1 - t0) * scale, (t2 - t1) * scale);
+    }
+}
+
+static void bench_orbit_from_state() {
+    enum { num_batch = 4096 };
+    static double x[num_batch], y[num_batch], z[num_batch];
+    static double vx[num_batch], vy[num_batch], vz[num_batch];
+    static double epoch[num_batch];
+    static struct orbit orbits[num_batch];
+
+    // catalog-like mix of inclined orbits, mostly elliptic
+    const double mu = 1.0;
+    for(int j = 0; j < num_batch; ++j) {
+        double p = 1.0 + (j % 13) / 4.0;
+        double e = (j % 8 == 7) ? 1.2 + (j % 5) / 2.0 : 0.02 + (j % 47) / 50.0;
+        double f = -2.0 + (j % 31) / 8.0;
+
+        struct orbit orbit;
+        orbit_from_elements(&orbit, mu, p, e,
+            0.1 * (j % 17), 0.2 * (j % 7), 0.3 * (j % 11), 0.0);
+
+        double pos[4], vel[4];
+        orbit_state_true(&orbit, pos, vel, f);
+        x[j] = pos[0]; y[j] = pos[1]; z[j] = pos[2];
+        vx[j] = vel[0]; vy[j] = vel[1]; vz[j] = vel[2];
+        epoch[j] = j;
+    }
+
+    const int repeat = 100;
+    double t0 = bench_clock();
+    for(int r = 0; r < repeat; ++r)
+        for(int j = 0; j < num_batch; ++j)
+            orbit_from_state(orbits + j, mu,
+                (vec4d){ x[j], y[j], z[j], 0.0 },
+                (vec4d){ vx[j], vy[j], vz[j], 0.0 },
+                epoch[j]);
+    double t1 = bench_clock();
+    for(int r = 0; r < repeat; ++r)
+        orbit_from_state_n(orbits, mu, x, y, z, vx, vy, vz, epoch, num_batch);
+    double t2 = bench_clock();
+    bench_sink = orbits[0].periapsis_time;
+
+    double scale = 1.0e9 / (repeat * num_batch);
+    printf("%10s %10s  (ns per orbit)\n", "scalar", "batch");
+    printf("%10.1f %10.1f\n", (t1 - t0) * scale, (t2 - t1) * scale);
+}
+
+const struct bench_case bench_cases[] = {
+    { "hyperbolic", bench_hyperbolic },
+    { "fixed", bench_fixed },
+    { "float", bench_float },
+    { "tol", bench_tol },
+    { "autotune", bench_autotune },
+    { "stumpff", bench_stumpff },
+    { "stumpff_derivatives", bench_stumpff_derivatives },
+    { "universal_propagate", bench_universal_propagate },
+    { "universal_guess", bench_universal_guess },
+    { "universal_fg", bench_universal_fg },
+    { "eccentric_state", bench_eccentric_state },
+    { "true_state", bench_true_state },
+    { "anomaly_conversion", bench_anomaly_conversion },
+    { "orbit_from_state", bench_orbit_from_state },
+    { 0, 0 }
+};
+
+int main(int argc, char *argv[]) {
+    int run = 0;
+
+    for(const struct bench_case *bench = bench_cases + 0;
+        bench->name != 0;
+        ++bench) {
+        int skip = argc > 1;
+        for(int i = 1; i < argc; ++i)
+            if(strcmp(bench->name, argv[i]) == 0)
+                skip = 0;
+        if(skip)
+            continue;
+
+        printf("*** %s\n", bench->name);
+        bench->func();
+        run += 1;
+    }
+
+    if(!run) {
+        fprintf(stderr, "NO BENCHMARKS RUN\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
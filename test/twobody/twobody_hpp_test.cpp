@@ -0,0 +1,114 @@
+#include <twobody/twobody.hpp>
+
+extern "C" {
+#include "../numtest.h"
+}
+
+template <typename Conic>
+static void hpp_check(
+    double mu, double p, double e, double M,
+    struct numtest_ctx *test_ctx) {
+    // fixed step count, near e = 1 the C near-parabolic solver, the C
+    // parabolic anomaly cancels for M < 0 (the closed form here does not)
+    double E = twobody::anomaly_mean_to_eccentric<Conic>(e, M);
+    double E_c = anomaly_mean_to_eccentric(e, M);
+    double tol = conic_parabolic(e) ? 1.0e-7 : 1.0e-13;
+    ASSERT(fabs(E - E_c) <= tol * fmax(1.0, fabs(E_c)),
+        "Eccentric anomaly (e = %.17g, M = %g)", e, M);
+    ASSERT_EQF(twobody::anomaly_eccentric_to_mean<Conic>(e, E),
+        anomaly_eccentric_to_mean(e, E),
+        "Mean anomaly");
+    ASSERT_EQF(twobody::anomaly_eccentric_to_true<Conic>(e, E),
+        anomaly_eccentric_to_true(e, E),
+        "True anomaly");
+
+    ASSERT_EQF(twobody::conic_mean_motion<Conic>(mu, p, e),
+        conic_mean_motion(mu, p, e),
+        "Mean motion");
+    ASSERT_EQF(twobody::eccentric_radius<Conic>(p, e, E),
+        eccentric_radius(p, e, E),
+        "Radius");
+
+    double x, y, xdot, ydot;
+    twobody::eccentric_xy<Conic>(mu, p, e, E, &x, &y, &xdot, &ydot);
+    ASSERT_EQF(x, eccentric_x(p, e, E), "Position x");
+    ASSERT_EQF(y, eccentric_y(p, e, E), "Position y");
+    ASSERT_EQF(xdot, eccentric_xdot(mu, p, e, E), "Velocity x");
+    ASSERT_EQF(ydot, eccentric_ydot(mu, p, e, E), "Velocity y");
+
+    double f = twobody::anomaly_eccentric_to_true<Conic>(e, E);
+    double tx, ty, txdot, tydot;
+    twobody::true_xy<Conic>(mu, p, e, f, &tx, &ty, &txdot, &tydot);
+    ASSERT_EQF(tx, true_x(p, e, f), "True position x");
+    ASSERT_EQF(ty, true_y(p, e, f), "True position y");
+    ASSERT_EQF(txdot, true_xdot(mu, p, e, f), "True velocity x");
+    ASSERT_EQF(tydot, true_ydot(mu, p, e, f), "True velocity y");
+
+#ifndef TWOBODY_NO_SIMD
+    // every lane matches the scalar kernel
+    vec4d MM = { M, -M, 0.5*M, 2.0*M };
+    vec4d EE = twobody::anomaly_mean_to_eccentric<Conic>(splat4d(e), MM);
+    for(int lane = 0; lane < 4; ++lane) {
+        double E_lane = twobody::anomaly_mean_to_eccentric<Conic>(e, MM[lane]);
+        ASSERT(fabs(EE[lane] - E_lane) <= 1.0e-13 * fmax(1.0, fabs(E_lane)),
+            "Eccentric anomaly (vec4d)");
+    }
+
+    vec8f MMf = { (float)M, (float)-M, (float)(0.5*M), (float)(2.0*M),
+        (float)(0.25*M), (float)(-0.5*M), 0.0f, (float)(4.0*M) };
+    vec8f EEf = twobody::anomaly_mean_to_eccentric<Conic>(splat8f(e), MMf);
+    for(int lane = 0; lane < 8; ++lane) {
+        float E_lane = twobody::anomaly_mean_to_eccentric<Conic>((float)e, MMf[lane]);
+        ASSERT(fabs(EEf[lane] - E_lane) <= 1.0e-5 * fmax(1.0, fabs(E_lane)),
+            "Eccentric anomaly (vec8f)");
+    }
+
+    vec4d xx, yy, xxdot, yydot;
+    twobody::eccentric_xy<Conic>(splat4d(mu), splat4d(p), splat4d(e), EE,
+        &xx, &yy, &xxdot, &yydot);
+    for(int lane = 0; lane < 4; ++lane) {
+        twobody::eccentric_xy<Conic>(mu, p, e, EE[lane], &x, &y, &xdot, &ydot);
+        // relative to the magnitude, sin(2pi k) is zero or an ulp
+        ASSERT(eqv4d((vec4d){ xx[lane], yy[lane], 0.0, 0.0 },
+                (vec4d){ x, y, 0.0, 0.0 }) &&
+            eqv4d((vec4d){ xxdot[lane], yydot[lane], 0.0, 0.0 },
+                (vec4d){ xdot, ydot, 0.0, 0.0 }),
+            "Position and velocity (vec4d)");
+    }
+#endif
+
+    // single precision, about 1e-6 relative (times 1/(1 - e) near periapsis)
+    float Ef = twobody::anomaly_mean_to_eccentric<Conic>((float)e, (float)M);
+    double E_cf = anomaly_mean_to_eccentric((float)e, (float)M);
+    ASSERT(fabs(Ef - E_cf) < 1.0e-4 * fmax(1.0, fabs(E_cf)),
+        "Eccentric anomaly (float)");
+}
+
+extern "C" void twobody_hpp_test(
+    double *params,
+    int num_params,
+    void *extra_args,
+    struct numtest_ctx *test_ctx) {
+    (void)extra_args;
+    ASSERT(num_params == 4, "");
+
+    double mu = 1.0 + params[0] * 1.0e10;
+    double p = 1.0 + params[1] * 1.0e10;
+
+    // graded towards e = 1 from both sides
+    double e_elliptic = 1.0 - pow(10.0, -6.0 * params[2]);
+    double e_hyperbolic = 1.0 + pow(10.0, -6.0 + 6.6 * params[2]);
+
+    hpp_check<twobody::elliptic>(mu, p, e_elliptic,
+        (-1.0 + 2.0*params[3]) * 4.0*M_PI, test_ctx);
+    hpp_check<twobody::hyperbolic>(mu, p, e_hyperbolic,
+        (-1.0 + 2.0*params[3]) * 100.0, test_ctx);
+    hpp_check<twobody::parabolic>(mu, p, 1.0,
+        (-1.0 + 2.0*params[3]) * 100.0, test_ctx);
+
+    // asymptotic starter, b*b of the cubic overflows above 1e154
+    double Mhuge = (-1.0 + 2.0*params[3]) * 1.0e300;
+    ASSERT_EQF(twobody::anomaly_mean_to_eccentric<twobody::hyperbolic>(e_hyperbolic, Mhuge),
+        anomaly_mean_to_eccentric(e_hyperbolic, Mhuge),
+        "Hyperbolic anomaly (huge)");
+}
@@ -6,30 +6,50 @@ uint64_t numtest_num_cases_default = 1 << 23;
 extern numtest_callback
     conic_test,
     anomaly_test,
+    anomaly_batch_test,
+    anomaly_float_test,
+    kepler_ctx_test,
     true_anomaly_test,
     eccentric_anomaly_test,
     orientation_test,
     orbit_from_state_test,
     orbit_from_elements_test,
     orbit_radial_test,
+    orbit_cursor_test,
+    orbit_float_test,
+    orbit_batch_test,
     stumpff_test,
     universal_test,
+    universal_propagate_test,
+    universal_propagate_batch_test,
     fg_test,
+    twobody_hpp_test,
+    twobody_autotune_test,
     dummy_test;
 
 const struct numtest_case numtest_cases[] = {
-    { "conic", conic_test, 3, 0 },
-    { "anomaly", anomaly_test, 2, 0 },
-    { "true_anomaly", true_anomaly_test, 4, 0 },
-    { "eccentric_anomaly", eccentric_anomaly_test, 4, 0 },
-    { "orientation", orientation_test, 3, 0 },
-    { "orbit_from_state", orbit_from_state_test, 7, 0 },
-    { "orbit_from_elements", orbit_from_elements_test, 6, 0 },
-    { "orbit_radial", orbit_radial_test, 5, 0 },
-    { "stumpff", stumpff_test, 2, 0 },
-    { "universal", universal_test, 5, 0 },
-    { "fg", fg_test, 5, 0 },
-    { 0, 0, 0, 0 }
+    { "conic", conic_test, 3, 0, 0 },
+    { "anomaly", anomaly_test, 2, 0, 0 },
+    { "anomaly_batch", anomaly_batch_test, 2, 0, 0 },
+    { "anomaly_float", anomaly_float_test, 2, 0, 0 },
+    { "kepler_ctx", kepler_ctx_test, 4, 0, 0 },
+    { "true_anomaly", true_anomaly_test, 4, 0, 0 },
+    { "eccentric_anomaly", eccentric_anomaly_test, 4, 0, 0 },
+    { "orientation", orientation_test, 3, 0, 0 },
+    { "orbit_from_state", orbit_from_state_test, 7, 0, 0 },
+    { "orbit_from_elements", orbit_from_elements_test, 6, 0, 0 },
+    { "orbit_radial", orbit_radial_test, 5, 0, 0 },
+    { "orbit_cursor", orbit_cursor_test, 5, 0, 0 },
+    { "orbit_float", orbit_float_test, 4, 0, 0 },
+    { "orbit_batch", orbit_batch_test, 5, 0, 0 },
+    { "stumpff", stumpff_test, 2, 0, 0 },
+    { "universal", universal_test, 5, 0, 0 },
+    { "universal_propagate", universal_propagate_test, 5, 0, 0 },
+    { "universal_propagate_batch", universal_propagate_batch_test, 5, 0, 0 },
+    { "fg", fg_test, 5, 0, 0 },
+    { "twobody_hpp", twobody_hpp_test, 4, 0, 0 },
+    { "autotune", twobody_autotune_test, 2, 0, 1024 }, // tunes and writes files
+    { 0, 0, 0, 0, 0 }
     };
 
 int main(int argc, char *argv[]) {
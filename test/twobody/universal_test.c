@@ -3,6 +3,7 @@
 #include <twobody/eccentric_anomaly.h>
 #include <twobody/stumpff.h>
 #include <twobody/universal.h>
+#include <twobody/simd4d.h>
 
 #include <math.h>
 
@@ -91,13 +92,36 @@ void universal_test(
     double s0 = universal_guess_s(mu, alpha, r1, sigma1, t2-t1);
     ASSERT(isfinite(s0), "Universal variable initial guess not NaN");
 
-    if(conic_parabolic(e)) s0 = s + ds; // XXX: parabolic guess_s is broken
-
+    unsigned long histogram[UNIVERSAL_MAX_STEPS + 1] = { 0 };
+    universal_set_histogram(histogram);
     double ss = universal_iterate_s(mu, alpha, r1, sigma1, s0, t2-t1, 0);
+    universal_set_histogram(0);
     ASSERT(isfinite(ss), "Universal variable time of flight not NaN");
 
+    unsigned long solves = 0;
+    for(int k = 0; k <= UNIVERSAL_MAX_STEPS; ++k)
+        solves += histogram[k];
+    ASSERT(solves == 1 && histogram[0] == 0 && histogram[UNIVERSAL_MAX_STEPS] == 0,
+        "Universal variable step histogram");
+
     ASSERT_EQF(s, ss, "Time of flight equation");
 
+    universal_set_histogram(histogram);
+    double ss_fixed = universal_iterate_s_fixed(mu, alpha, r1, sigma1, s0, t2-t1, 20);
+    universal_set_histogram(0);
+
+    solves = 0;
+    for(int k = 0; k <= UNIVERSAL_MAX_STEPS; ++k)
+        solves += histogram[k];
+    ASSERT(solves == 1, "Fixed steps not in the histogram");
+
+    ASSERT_EQF(s, ss_fixed, "Time of flight equation (fixed steps)");
+
+    const double tol = 1.0e-6;
+    double ss_tol = universal_iterate_s_tol(mu, alpha, r1, sigma1, s0, t2-t1, 0, tol);
+    ASSERT(fabs(s - ss_tol) <= 4.0 * tol * fmax(1.0, fabs(s)),
+        "Time of flight equation (tolerance)");
+
     double s_half = s/2.0, z_half = alpha * s_half*s_half;
     double cs_half[4];
     stumpff_fast(z_half, cs_half);
@@ -118,3 +142,162 @@ void universal_test(
     else
         ASSERT_EQF(fabs(ff), 2.0*M_PI, "Universal to true (2pi)");
 }
+
+static double universal_state_error(vec4d pos, vec4d vel, vec4d pos_ref, vec4d vel_ref) {
+    // relative to the magnitude, components may be zero
+    double dpos = mag(xyz4d(pos - pos_ref)) / mag(pos_ref);
+    double dvel = mag(xyz4d(vel - vel_ref)) / mag(vel_ref);
+    return dpos > dvel ? dpos : dvel;
+}
+
+void universal_propagate_test(
+    double *params,
+    int num_params,
+    void *extra_args,
+    struct numtest_ctx *test_ctx) {
+    (void)extra_args;
+    ASSERT(num_params == 5, "");
+
+    double mu = 1.0 + params[0] * 1.0e8;
+    double p = 1.0 + params[1] * 1.0e8;
+    double e = params[2] * 4.0;
+    double n = conic_mean_motion(mu, p, e);
+
+    double E1 = (-1.0 + params[3] * 2.0) * M_PI;
+    double E2 = (-1.0 + params[4] * 2.0) * M_PI;
+    double dt = (anomaly_eccentric_to_mean(e, E2) -
+        anomaly_eccentric_to_mean(e, E1)) / n;
+
+    // orbit plane tilted about the x axis
+    double ci = cos(params[4] * M_PI), si = sin(params[4] * M_PI);
+    vec4d pos1 = {
+        eccentric_x(p, e, E1), ci * eccentric_y(p, e, E1), si * eccentric_y(p, e, E1), 0.0 };
+    vec4d vel1 = {
+        eccentric_xdot(mu, p, e, E1),
+        ci * eccentric_ydot(mu, p, e, E1), si * eccentric_ydot(mu, p, e, E1), 0.0 };
+    vec4d pos2 = {
+        eccentric_x(p, e, E2), ci * eccentric_y(p, e, E2), si * eccentric_y(p, e, E2), 0.0 };
+    vec4d vel2 = {
+        eccentric_xdot(mu, p, e, E2),
+        ci * eccentric_ydot(mu, p, e, E2), si * eccentric_ydot(mu, p, e, E2), 0.0 };
+
+    vec4d pos = pos1, vel = vel1;
+    universal_propagate(mu, (double*)&pos1, (double*)&vel1, dt,
+        (double*)&pos, (double*)&vel);
+
+    ASSERT(isfinite(mag(pos)) && isfinite(mag(vel)),
+        "Universal propagate state not NaN");
+    ASSERT(ZEROF(universal_state_error(pos, vel, pos2, vel2)),
+        "Universal propagate and eccentric anomaly state");
+
+    // in place and backwards
+    universal_propagate(mu, (double*)&pos, (double*)&vel, -dt,
+        (double*)&pos, (double*)&vel);
+    ASSERT(ZEROF(universal_state_error(pos, vel, pos1, vel1)),
+        "Universal propagate backwards");
+
+    // radial orbit, velocity along the position
+    vec4d vel_radial = pos1 * splat4d(dot(vel1, pos1) / dot(pos1, pos1));
+    if(dot(vel_radial, vel_radial) > 0.0) {
+        double r0 = mag(pos1);
+        double dt_radial = dt * 1.0e-3; // no collision
+        double energy = dot(vel_radial, vel_radial)/2.0 - mu/r0;
+
+        vec4d pos_radial = pos1, vel_radial2 = vel_radial;
+        universal_propagate(mu, (double*)&pos1, (double*)&vel_radial, dt_radial,
+            (double*)&pos_radial, (double*)&vel_radial2);
+
+        ASSERT(isfinite(mag(pos_radial)) && isfinite(mag(vel_radial2)),
+            "Universal propagate radial state not NaN");
+        ASSERT(ZEROF(mag(cross(pos_radial, vel_radial2)) /
+                (mag(pos_radial) * mag(vel_radial2))),
+            "Universal propagate radial stays radial");
+        ASSERT_EQF(energy,
+            dot(vel_radial2, vel_radial2)/2.0 - mu/mag(pos_radial),
+            "Universal propagate radial energy");
+    }
+
+    // radial parabolic orbit, escape velocity outwards:
+    //   r^(3/2) = r0^(3/2) + 3/2 sqrt(2 mu) t
+    double r0 = mag(pos1);
+    vec4d vel_escape = pos1 * splat4d(sqrt(2.0 * mu / r0) / r0);
+    double dt_escape = fabs(dt);
+
+    vec4d pos_escape = pos1, vel_escape2 = vel_escape;
+    universal_propagate(mu, (double*)&pos1, (double*)&vel_escape, dt_escape,
+        (double*)&pos_escape, (double*)&vel_escape2);
+
+    ASSERT(isfinite(mag(pos_escape)) && isfinite(mag(vel_escape2)),
+        "Universal propagate radial parabolic state not NaN");
+    ASSERT_EQF(mag(pos_escape),
+        pow(pow(r0, 1.5) + 1.5 * sqrt(2.0 * mu) * dt_escape, 2.0/3.0),
+        "Universal propagate radial parabolic radius");
+    ASSERT_EQF(mag(vel_escape2), sqrt(2.0 * mu / mag(pos_escape)),
+        "Universal propagate radial parabolic velocity");
+}
+
+void universal_propagate_batch_test(
+    double *params,
+    int num_params,
+    void *extra_args,
+    struct numtest_ctx *test_ctx) {
+    (void)extra_args;
+    ASSERT(num_params == 5, "");
+
+    double mu = 1.0 + params[0] * 1.0e8;
+    double p = 1.0 + params[1] * 1.0e8;
+
+    // an elliptic batch, a hyperbolic batch with a radial parabolic lane
+    // and a mixed remainder
+    const int n = 11;
+    double x[n], y[n], z[n], vx[n], vy[n], vz[n], dt[n];
+    vec4d pos[n], vel[n];
+
+    for(int i = 0; i < n; ++i) {
+        double e = i < 4 ?
+            params[2] * (1.0 - i / 8.0) :         // elliptic
+            (i < 8 ?
+                1.0 + 1.0e-4 + params[2] * (i - 3) : // hyperbolic
+                params[2] * 4.0 * (i - 7) / 3.0);    // any conic
+        double t = fmod(params[4] + i / (double)n, 1.0);
+
+        double E1 = (-1.0 + params[3] * 2.0) * M_PI;
+        double E2 = (-1.0 + t * 2.0) * M_PI;
+        dt[i] = (anomaly_eccentric_to_mean(e, E2) -
+            anomaly_eccentric_to_mean(e, E1)) / conic_mean_motion(mu, p, e);
+
+        double ci = cos(t * M_PI), si = sin(t * M_PI);
+        pos[i] = (vec4d){
+            eccentric_x(p, e, E1), ci * eccentric_y(p, e, E1),
+            si * eccentric_y(p, e, E1), 0.0 };
+        vel[i] = (vec4d){
+            eccentric_xdot(mu, p, e, E1),
+            ci * eccentric_ydot(mu, p, e, E1),
+            si * eccentric_ydot(mu, p, e, E1), 0.0 };
+
+        if(i == 7) { // escape velocity outwards
+            double r0 = mag(pos[i]);
+            vel[i] = pos[i] * splat4d(sqrt(2.0 * mu / r0) / r0);
+            dt[i] = fabs(dt[i]);
+        }
+
+        x[i] = pos[i][0]; y[i] = pos[i][1]; z[i] = pos[i][2];
+        vx[i] = vel[i][0]; vy[i] = vel[i][1]; vz[i] = vel[i][2];
+    }
+
+    universal_propagate_n(mu, x, y, z, vx, vy, vz, dt, n);
+
+    for(int i = 0; i < n; ++i) {
+        vec4d pos2 = pos[i], vel2 = vel[i];
+        universal_propagate(mu, (double*)&pos[i], (double*)&vel[i], dt[i],
+            (double*)&pos2, (double*)&vel2);
+
+        vec4d pos_n = { x[i], y[i], z[i], 0.0 };
+        vec4d vel_n = { vx[i], vy[i], vz[i], 0.0 };
+
+        ASSERT(isfinite(mag(pos_n)) && isfinite(mag(vel_n)),
+            "Batch propagate state not NaN (batch %d)", i);
+        ASSERT(ZEROF(universal_state_error(pos_n, vel_n, pos2, vel2)),
+            "Batch and scalar universal propagate (batch %d)", i);
+    }
+}